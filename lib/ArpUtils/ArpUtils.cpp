@@ -21,7 +21,26 @@ const char *modeNames[] = {
     "Random Chord Percent",
     "Rhythm Pattern",
     "Range Shift",
-    "Range Stretch"};
+    "Range Stretch",
+    "Chord Input Mode",
+    "Voice Leading",
+    "Chord Fill",
+    "Scale",
+    "Scale Root",
+    "Transpose Channel",
+    "Groove",
+    "Swing",
+    "Tempo Ramp",
+    "Sync",
+    "Clock Source",
+    "Time Signature",
+    "Polymeter",
+    "Ratchet",
+    "Ratchet Prob",
+    "Ratchet Decay",
+    "Humanize Profile",
+    "Tap Tempo",
+    "Clock Ratio"};
 
 template <typename T>
 void printIfChanged(const char *label, T &lastValue, T currentValue, T printValue)
@@ -37,6 +56,7 @@ void printIfChanged(const char *label, T &lastValue, T currentValue, T printValu
 // Explicit template instantiations for common types
 template void printIfChanged<int>(const char *, int &, int, int);
 template void printIfChanged<bool>(const char *, bool &, bool, bool);
+template void printIfChanged<float>(const char *, float &, float, float);
 // Add more explicit instantiations if needed
 
 // --- ENCODER STATE MACHINE ---
@@ -0,0 +1,110 @@
+#include "ChordRecognition.h"
+
+const char *chordTypeNames[CHORD_TYPE_COUNT] = {
+    "?", "", "m", "dim", "aug", "sus2", "sus4", "maj7", "m7", "7", "m7b5", "dim7", "m(maj7)", "6", "m6"};
+
+const char *pitchClassNames[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+// Root-relative interval masks, indexed by ChordType. Order doubles as the
+// tie-break priority when two readings of a mask are equally complete.
+static constexpr uint16_t chordTemplates[CHORD_TYPE_COUNT] = {
+    0,                                               // CHORD_NONE
+    (1 << 0) | (1 << 4) | (1 << 7),                  // CHORD_MAJ
+    (1 << 0) | (1 << 3) | (1 << 7),                  // CHORD_MIN
+    (1 << 0) | (1 << 3) | (1 << 6),                  // CHORD_DIM
+    (1 << 0) | (1 << 4) | (1 << 8),                  // CHORD_AUG
+    (1 << 0) | (1 << 2) | (1 << 7),                  // CHORD_SUS2
+    (1 << 0) | (1 << 5) | (1 << 7),                  // CHORD_SUS4
+    (1 << 0) | (1 << 4) | (1 << 7) | (1 << 11),      // CHORD_MAJ7
+    (1 << 0) | (1 << 3) | (1 << 7) | (1 << 10),      // CHORD_MIN7
+    (1 << 0) | (1 << 4) | (1 << 7) | (1 << 10),      // CHORD_DOM7
+    (1 << 0) | (1 << 3) | (1 << 6) | (1 << 10),      // CHORD_HALFDIM7
+    (1 << 0) | (1 << 3) | (1 << 6) | (1 << 9),       // CHORD_DIM7
+    (1 << 0) | (1 << 3) | (1 << 7) | (1 << 11),      // CHORD_MINMAJ7
+    (1 << 0) | (1 << 4) | (1 << 7) | (1 << 9),       // CHORD_MAJ6
+    (1 << 0) | (1 << 3) | (1 << 7) | (1 << 9)};      // CHORD_MIN6
+
+static constexpr uint16_t rotateMask(uint16_t mask, int semitones)
+{
+    // Rotate a 12-bit mask down by semitones (pitch class semitones -> bit 0)
+    return ((mask >> semitones) | (mask << (12 - semitones))) & 0x0FFF;
+}
+
+static constexpr int popCount(uint16_t mask)
+{
+    int count = 0;
+    for (; mask; mask &= mask - 1)
+        ++count;
+    return count;
+}
+
+// Packed entry: type in the high nibble, root in the low nibble.
+// A mask matches a type if it is a subset of the template with at most one
+// tone missing and the root present; fewer missing tones win.
+static constexpr uint8_t classifyMask(uint16_t mask)
+{
+    if (popCount(mask) < 2)
+        return 0;
+    int bestType = CHORD_NONE;
+    int bestRoot = 0;
+    int bestMissing = 2;
+    for (int type = 1; type < CHORD_TYPE_COUNT; ++type)
+    {
+        for (int root = 0; root < 12; ++root)
+        {
+            if (!(mask & (1 << root)))
+                continue;
+            uint16_t rel = rotateMask(mask, root);
+            if (rel & ~chordTemplates[type])
+                continue;
+            int missing = popCount(chordTemplates[type]) - popCount(rel);
+            if (missing < bestMissing)
+            {
+                bestType = type;
+                bestRoot = root;
+                bestMissing = missing;
+            }
+        }
+    }
+    return static_cast<uint8_t>((bestType << 4) | bestRoot);
+}
+
+struct ChordLookupTable
+{
+    uint8_t entries[4096];
+};
+
+static constexpr ChordLookupTable makeChordLookupTable()
+{
+    ChordLookupTable table{};
+    for (int mask = 0; mask < 4096; ++mask)
+        table.entries[mask] = classifyMask(static_cast<uint16_t>(mask));
+    return table;
+}
+
+static constexpr ChordLookupTable chordLookup = makeChordLookupTable();
+
+uint16_t pitchClassMask(const std::vector<uint8_t> &notes)
+{
+    uint16_t mask = 0;
+    for (uint8_t n : notes)
+        mask |= 1 << (n % 12);
+    return mask;
+}
+
+ChordInfo recognizeChord(uint16_t mask)
+{
+    mask &= 0x0FFF;
+    uint8_t entry = chordLookup.entries[mask];
+    ChordType type = static_cast<ChordType>(entry >> 4);
+    uint8_t root = entry & 0x0F;
+    uint8_t missing = 0;
+    if (type != CHORD_NONE)
+        missing = popCount(chordTemplateMask(type, root) & ~mask);
+    return {type, root, missing};
+}
+
+uint16_t chordTemplateMask(ChordType type, uint8_t root)
+{
+    return rotateMask(chordTemplates[type], (12 - root) % 12);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// --- CHORD RECOGNITION ---
+// Chord type and root for every 12-bit pitch-class mask, generated at compile
+// time into a 4096-entry table. Recognition is a single table lookup.
+enum ChordType
+{
+    CHORD_NONE,
+    CHORD_MAJ,
+    CHORD_MIN,
+    CHORD_DIM,
+    CHORD_AUG,
+    CHORD_SUS2,
+    CHORD_SUS4,
+    CHORD_MAJ7,
+    CHORD_MIN7,
+    CHORD_DOM7,
+    CHORD_HALFDIM7,
+    CHORD_DIM7,
+    CHORD_MINMAJ7,
+    CHORD_MAJ6,
+    CHORD_MIN6,
+    CHORD_TYPE_COUNT // must be last
+};
+
+struct ChordInfo
+{
+    ChordType type;
+    uint8_t root;    // Pitch class 0..11 (C..B)
+    uint8_t missing; // Chord tones not present in the mask (0 = complete)
+};
+
+extern const char *chordTypeNames[CHORD_TYPE_COUNT];
+extern const char *pitchClassNames[12];
+
+// 12-bit pitch-class mask of a set of MIDI notes (bit 0 = C)
+uint16_t pitchClassMask(const std::vector<uint8_t> &notes);
+
+// Look up the chord for a pitch-class mask
+ChordInfo recognizeChord(uint16_t mask);
+
+// Pitch-class mask of the complete chord of the given type and root
+uint16_t chordTemplateMask(ChordType type, uint8_t root);
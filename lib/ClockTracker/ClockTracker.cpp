@@ -0,0 +1,135 @@
+#include "ClockTracker.h"
+
+// Steady-state gains: about a 10-tick phase and 40-tick tempo time constant
+static const float minPhaseGain = 0.1f;
+static const float minPeriodGain = 0.005f;
+
+void ClockTracker::reset()
+{
+    *this = ClockTracker();
+}
+
+void ClockTracker::reacquire()
+{
+    uint32_t nextTick = ticks;
+    reset();
+    ticks = nextTick;
+}
+
+void ClockTracker::acquire(uint64_t tickUs)
+{
+    estimateUs = tickUs;
+    estimateFrac = 0;
+    samples = 1;
+    goodTicks = 0;
+    outliers = 0;
+}
+
+void ClockTracker::advanceEstimate(float offset)
+{
+    int64_t whole = static_cast<int64_t>(offset);
+    if (static_cast<float>(whole) > offset)
+        --whole; // floor for negative offsets
+    estimateUs += whole;
+    estimateFrac = offset - static_cast<float>(whole);
+}
+
+void ClockTracker::tick(uint64_t tickUs)
+{
+    uint64_t rawUs = lastRawUs;
+    lastRawUs = tickUs;
+
+    if (samples == 0)
+    {
+        ++ticks;
+        acquire(tickUs);
+        return;
+    }
+    if (samples == 1)
+    {
+        // Second tick: the interval is the first period estimate
+        ++ticks;
+        period = static_cast<float>(tickUs - rawUs);
+        estimateUs = tickUs;
+        estimateFrac = 0;
+        samples = 2;
+        return;
+    }
+
+    // Error against the predicted tick, relative to the last estimate to keep floats small
+    float sinceEstimate = static_cast<float>(static_cast<int64_t>(tickUs - estimateUs)) - estimateFrac;
+    float cycles = sinceEstimate / period;
+    if (cycles > 1.5f && cycles < maxMissedTicks + 1.5f)
+    {
+        // Dropped ticks: step the estimate over them so the beat position stays right
+        int missed = static_cast<int>(cycles + 0.5f) - 1;
+        advanceEstimate(estimateFrac + missed * period);
+        ticks += missed;
+        sinceEstimate -= missed * period;
+    }
+    float error = sinceEstimate - period;
+    if (error > outlierGate * period || error < -outlierGate * period)
+    {
+        // Duplicate or badly delayed tick: coast, and re-acquire if it persists
+        goodTicks = 0;
+        if (++outliers >= maxOutliers)
+        {
+            ++ticks;
+            acquire(tickUs);
+        }
+        return;
+    }
+    outliers = 0;
+    ++ticks;
+
+    // Least-squares alpha-beta gains for the first n ticks, floored at the steady state
+    float n = static_cast<float>(samples + 1);
+    float phaseGain = 2.0f * (2.0f * n - 1.0f) / (n * (n + 1.0f));
+    float periodGain = 6.0f / (n * (n + 1.0f));
+    if (phaseGain < minPhaseGain)
+        phaseGain = minPhaseGain;
+    if (periodGain < minPeriodGain)
+        periodGain = minPeriodGain;
+    ++samples;
+
+    advanceEstimate(estimateFrac + period + phaseGain * error);
+    period += periodGain * error;
+
+    if (goodTicks < lockTicks)
+        ++goodTicks;
+}
+
+bool ClockTracker::timedOut(uint64_t nowUs) const
+{
+    if (samples == 0)
+        return true;
+    float limit = samples >= 2 ? 4.0f * period : 250000.0f; // Four ticks, or a 10 BPM tick before the first period
+    return static_cast<float>(nowUs - lastRawUs) > limit;
+}
+
+float ClockTracker::bpm() const
+{
+    return period > 0 ? 60000000.0f / (clockTicksPerBeat * period) : 0;
+}
+
+uint64_t ClockTracker::nextTickUs() const
+{
+    return estimateUs + static_cast<uint64_t>(estimateFrac + period + 0.5f);
+}
+
+uint64_t ClockTracker::tickTimeUs(uint32_t tick, float fraction) const
+{
+    if (ticks == 0)
+        return estimateUs;
+    // Signed tick distance from the last estimate (index ticks - 1)
+    float ticksAhead = static_cast<float>(static_cast<int32_t>(tick - (ticks - 1))) + fraction;
+    float offset = estimateFrac + ticksAhead * period;
+    return estimateUs + static_cast<int64_t>(offset + (offset >= 0 ? 0.5f : -0.5f));
+}
+
+float ClockTracker::phaseTicks(uint64_t nowUs) const
+{
+    if (period <= 0)
+        return 0;
+    return (static_cast<float>(static_cast<int64_t>(nowUs - estimateUs)) - estimateFrac) / period;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+
+// --- MIDI CLOCK TRACKER ---
+// Phase-locked loop on incoming 24 PPQN clock ticks. Each tick's timestamp is
+// compared with the predicted tick time and the error steers both the phase
+// and the tick period (an alpha-beta filter, i.e. a steady-state Kalman
+// filter). Gains start at the least-squares line fit of the ticks seen so
+// far, so lock comes within a few ticks, then settle to small fixed values
+// that reject timestamp jitter. Tempo and phase are fractional and updated
+// every tick. No Arduino dependency: feed it synthetic timestamps on host.
+
+const int clockTicksPerBeat = 24;
+
+class ClockTracker
+{
+public:
+    static const uint32_t lockTicks = 6;       // Consecutive in-gate ticks before locked()
+    static const uint32_t maxOutliers = 3;     // Consecutive rejected ticks before re-acquiring
+    static const int maxMissedTicks = 3;       // Gaps up to this many dropped ticks are bridged
+    static constexpr float outlierGate = 0.5f; // Reject ticks further than this many periods off
+
+    void reset();
+
+    // Feed one clock tick received at tickUs
+    void tick(uint64_t tickUs);
+
+    // Number the next tick (Start = 0, Continue = song position); timing is kept
+    void relocate(uint32_t nextTick) { ticks = nextTick; }
+    // Start timing over after a gap, keeping the tick numbering
+    void reacquire();
+
+    bool locked() const { return goodTicks >= lockTicks; }
+    // No tick for several periods: the source stopped or was unplugged
+    bool timedOut(uint64_t nowUs) const;
+
+    float periodUs() const { return period; }
+    float bpm() const;
+
+    // Ticks accepted since the last reset (the beat position is tickCount() % 24)
+    uint32_t tickCount() const { return ticks; }
+    // Filtered time of the last tick and the predicted time of the next
+    uint64_t lastTickUs() const { return estimateUs; }
+    uint64_t nextTickUs() const;
+    // Fractional ticks elapsed since the last filtered tick time
+    float phaseTicks(uint64_t nowUs) const;
+    // Filtered/predicted time of a tick index (0 = first tick), plus a fraction of a tick
+    uint64_t tickTimeUs(uint32_t tick, float fraction = 0) const;
+
+private:
+    uint64_t estimateUs = 0; // Filtered time of the last tick, whole microseconds
+    float estimateFrac = 0;  // ...plus this fraction
+    float period = 0;        // Filtered tick period, microseconds
+    uint32_t samples = 0;    // Ticks since acquisition started (drives the gain schedule)
+    uint32_t ticks = 0;
+    uint32_t goodTicks = 0;
+    uint32_t outliers = 0;
+    uint64_t lastRawUs = 0;  // Unfiltered time of the last tick
+
+    void acquire(uint64_t tickUs);
+    void advanceEstimate(float offset);
+};
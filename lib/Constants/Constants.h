@@ -18,24 +18,45 @@ const uint8_t encoder0PinB = encoderDT;
 // All arpeggiator parameters (defaults should be set in main.cpp, only constants here)
 const int maxTimingHumanizePercent = 100;
 const int maxNoteLengthRandomizePercent = 100;
+const int maxNoteLengthPercent = 200; // Gates above 100% overlap the next step (legato)
 const int minOctave = -3;
 const int maxOctave = 3;
 const int minTranspose = -3;
 const int maxTranspose = 3;
+const uint8_t transposeReferenceNote = 60; // Transpose note that leaves the sequence unshifted (C4)
 
 // Note resolution options (notes per beat)
 //const int notesPerBeatOptions[] = {1, 2, 3, 4, 6, 8, 12, 16};
 //const int notesPerBeatOptionsSize = sizeof(notesPerBeatOptions) / sizeof(notesPerBeatOptions[0]);
 
-// Steps per bar options for a 4-beat bar
+// Steps per bar options (the bar length comes from the time signature)
 const int stepsPerBarOptions[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 16, 24, 32};
 const int stepsPerBarOptionsSize = sizeof(stepsPerBarOptions) / sizeof(stepsPerBarOptions[0]);
 
+// Time signature options; BPM counts quarter notes, so a bar lasts
+// numerator * 96 / denominator MIDI clock ticks
+struct TimeSignature
+{
+    uint8_t numerator;
+    uint8_t denominator;
+};
+
+constexpr TimeSignature timeSignatureOptions[] = {{2, 4}, {3, 4}, {4, 4}, {5, 4}, {7, 4}, {5, 8}, {6, 8}, {7, 8}, {9, 8}, {12, 8}};
+const int timeSignatureOptionsSize = sizeof(timeSignatureOptions) / sizeof(timeSignatureOptions[0]);
+
+constexpr int barTicksFor(const TimeSignature &signature)
+{
+    return signature.numerator * 96 / signature.denominator;
+}
+
+// Polymeter: pattern length in steps, independent of the bar
+const int maxPolymeterSteps = 32;
+
 // extern variables
-extern int bpm;
-extern unsigned long arpInterval;
+extern float bpm;
 //extern int notesPerBeat;
 extern int stepsPerBar;
+extern int barTicks; // Bar length in MIDI clock ticks, from the time signature
 
 // --- Extern declarations for arpeggiator/chord state (needed by midiUtils.cpp) ---
 extern bool capturingChord;
@@ -45,6 +66,11 @@ extern std::vector<uint8_t> currentChord;
 extern size_t currentNoteIndex;
 extern int noteRepeatCounter;
 
+// --- Live transposition (sequencer-style, applied at emission time) ---
+extern uint8_t transposeChannel;   // 1-16, 0 = off
+extern uint8_t transposeSplitNote; // Notes below this transpose, 0 = off
+extern int liveTranspose;          // Semitones, set by the last transpose note
+
 // --- ENCODER MODES ---
 // List of all editable parameters for the encoder
 enum EncoderMode
@@ -57,7 +83,7 @@ enum EncoderMode
     MODE_PATTERN_PLAYBACK,
     MODE_REVERSE,
     MODE_SMOOTH, // Pattern smooth mode
-    MODE_STEPS,  // Number of steps in a 4-beat bar
+    MODE_STEPS,  // Number of steps in a bar
     MODE_BAR,   // Limit or repeat playingChord to match steps
     MODE_REPEAT,
     MODE_TRANSPOSE,
@@ -69,6 +95,25 @@ enum EncoderMode
     MODE_RHYTHM,       // Rhythm accent pattern selection
     MODE_RANGE,        // Range shift for lowest/highest note
     MODE_STRETCH,
+    MODE_INPUT,        // Chord input mode (latch / latch-add / held)
+    MODE_VOICING,      // Voice-leading for random chord steps
+    MODE_CHORD_FILL,   // Fill in missing tones of the recognised chord
+    MODE_SCALE,        // Output scale quantizer
+    MODE_SCALE_ROOT,   // Root of the quantizer scale
+    MODE_TRANSPOSE_CHANNEL, // MIDI channel whose notes transpose the sequence
+    MODE_GROOVE,            // Swing/groove template
+    MODE_SWING,             // Swing amount for the swing template
+    MODE_TEMPO_RAMP,        // Beats to glide to a new tempo
+    MODE_SYNC,              // Internal tempo, follow MIDI clock, or clock master
+    MODE_CLOCK_SOURCE,      // Clock input: auto, DIN or USB
+    MODE_TIME_SIGNATURE,    // Bar length: 2/4 ... 7/4, 5/8 ... 12/8
+    MODE_POLYMETER,         // Pattern length in steps against the bar (0 = off)
+    MODE_RATCHET,           // Hits per ratcheted step (1 = off)
+    MODE_RATCHET_PROBABILITY, // Chance that a step ratchets
+    MODE_RATCHET_DECAY,     // Velocity drop per ratchet hit
+    MODE_HUMANIZE_PROFILE,  // Timing humanize shape: uniform, gaussian, drift
+    MODE_TAP_TEMPO,         // Tap tempo; the encoder picks the tap input
+    MODE_CLOCK_RATIO,       // Clock divide/multiply when following MIDI clock
     MODE_COUNT // Stretch pattern up/down by adding notes
 };
 
@@ -77,4 +122,59 @@ enum PatternPlaybackMode
 {
     STRAIGHT,
     LOOP
-};
\ No newline at end of file
+};
+
+// --- Chord input mode: how incoming notes update the latched chord ---
+enum ChordInputMode
+{
+    LATCH,     // Releasing the lead note latches a new chord
+    LATCH_ADD, // Notes toggle in/out of the running chord without restarting it
+    HELD,      // Chord is exactly the keys held or sustained (CC64)
+    CHORD_INPUT_COUNT
+};
+
+extern ChordInputMode chordInputMode;
+
+// --- Clock sync mode ---
+enum SyncMode
+{
+    SYNC_INTERNAL, // Internal tempo; incoming MIDI clock is ignored
+    SYNC_FOLLOW,   // Follow incoming MIDI clock, steps locked to its ticks
+    SYNC_MASTER,   // Internal tempo, sent as MIDI clock with Start/Stop
+    SYNC_MODE_COUNT
+};
+
+extern SyncMode syncMode;
+
+// --- Clock source selection (DIN / USB) ---
+enum ClockSourceSelect
+{
+    CLOCK_SELECT_AUTO, // First running source, failing over to the other
+    CLOCK_SELECT_DIN,
+    CLOCK_SELECT_USB,
+    CLOCK_SELECT_COUNT
+};
+
+extern ClockSourceSelect clockSourceSelect;
+
+// --- Clock divide/multiply when following MIDI clock ---
+enum ClockRatio
+{
+    CLOCK_RATIO_HALF,    // Half time: a bar spans twice the clock ticks
+    CLOCK_RATIO_NORMAL,
+    CLOCK_RATIO_TRIPLET, // Triplet feel: three steps in the time of two
+    CLOCK_RATIO_DOUBLE,  // Double time: a bar spans half the clock ticks
+    CLOCK_RATIO_COUNT
+};
+
+extern ClockRatio clockRatio;
+
+// --- Tap tempo input (while the encoder is in MODE_TAP_TEMPO) ---
+enum TapInput
+{
+    TAP_CLEAR_BUTTON,   // Clear button taps instead of clearing
+    TAP_ENCODER_SWITCH, // Encoder switch taps; hold it to move to the next mode
+    TAP_INPUT_COUNT
+};
+
+extern TapInput tapInput;
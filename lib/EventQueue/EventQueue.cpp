@@ -0,0 +1,27 @@
+#include "EventQueue.h"
+
+bool EventQueue::push(const OutputEvent &event)
+{
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= eventQueueCapacity)
+        return false;
+    events[h & (eventQueueCapacity - 1)] = event;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool EventQueue::peek(OutputEvent &event) const
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+        return false;
+    event = events[t & (eventQueueCapacity - 1)];
+    return true;
+}
+
+void EventQueue::pop()
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t != head.load(std::memory_order_acquire))
+        tail.store(t + 1, std::memory_order_release);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// --- OUTPUT EVENT QUEUE ---
+// Preallocated single-producer/single-consumer ring of timestamped output
+// events. loop() renders steps into it ahead of time; the dispatcher timer
+// drains whatever is due. Events are pushed in nondecreasing time order.
+
+const size_t eventQueueCapacity = 128; // Power of two
+
+enum OutputEventType : uint8_t
+{
+    EVENT_NOTE_ON,
+    EVENT_NOTE_OFF,
+    EVENT_REALTIME // Clock/Start/Stop, status byte in note
+};
+
+struct OutputEvent
+{
+    uint64_t timeUs;  // Absolute time on the Timebase clock
+    uint64_t dueUs;   // Intended time, before clamping to now or to queue order (lateness counts from it)
+    uint8_t type;     // OutputEventType
+    uint8_t note;     // Note before transpose/scale (note on only)
+    uint8_t velocity; // Note on only
+    uint8_t voice;    // Links a note off to its note on
+};
+
+class EventQueue
+{
+public:
+    // Producer side
+    bool push(const OutputEvent &event);
+    size_t space() const { return eventQueueCapacity - depth(); }
+
+    // Consumer side
+    bool peek(OutputEvent &event) const;
+    void pop();
+
+    size_t depth() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+private:
+    OutputEvent events[eventQueueCapacity];
+    std::atomic<size_t> head{0}; // Written by the producer
+    std::atomic<size_t> tail{0}; // Written by the consumer
+};
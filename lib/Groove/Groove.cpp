@@ -0,0 +1,44 @@
+#include "Groove.h"
+
+const char *grooveNames[GROOVE_COUNT] = {"Straight", "Swing", "Shuffle", "MPC 16ths", "Laid Back", "Push"};
+
+struct GrooveTemplate
+{
+    int16_t permille[maxGrooveSteps]; // Offset in thousandths of a step
+    uint8_t length;
+};
+
+// GROOVE_SWING is generated from swingPercent; its entry here is unused
+static const GrooveTemplate grooveTemplates[GROOVE_COUNT] = {
+    {{0}, 1},                                                                          // Straight
+    {{0, 0}, 2},                                                                       // Swing
+    {{0, 333}, 2},                                                                     // Shuffle (66.7% swing)
+    {{0, 160, 0, 180, 0, 160, 0, 200, 0, 160, 0, 180, 0, 160, 0, 220}, 16},            // MPC 16ths
+    {{0, 20, 0, 20, 60, 40, 0, 20, 0, 20, 0, 20, 60, 40, 0, 20}, 16},                  // Laid back
+    {{0, -60, 0, -40, 0, -60, 0, -40}, 8}};                                            // Push
+
+void buildGrooveTable(GrooveTable &table, GrooveType type, int swingPercent, uint32_t stepUs)
+{
+    if (type < 0 || type >= GROOVE_COUNT)
+        type = GROOVE_STRAIGHT;
+
+    GrooveTemplate groove = grooveTemplates[type];
+    if (type == GROOVE_SWING)
+    {
+        if (swingPercent < minSwingPercent)
+            swingPercent = minSwingPercent;
+        if (swingPercent > maxSwingPercent)
+            swingPercent = maxSwingPercent;
+        // Swing % is where the off-beat lands within the pair: 50 = straight, 75 = half a step late
+        groove.permille[1] = (swingPercent - 50) * 20;
+    }
+
+    table.length = groove.length;
+    table.leadUs = 0;
+    for (int i = 0; i < groove.length; ++i)
+    {
+        table.offsetUs[i] = static_cast<int32_t>((static_cast<int64_t>(stepUs) * groove.permille[i]) / 1000);
+        if (-table.offsetUs[i] > static_cast<int32_t>(table.leadUs))
+            table.leadUs = -table.offsetUs[i];
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+// --- GROOVE ---
+// Swing and groove templates, stored as per-step offsets in permille of a
+// step and resolved into microsecond tables whenever the tempo, steps per bar
+// or groove change. Applying groove at emission is one table lookup.
+
+const int maxGrooveSteps = 16;
+const int minSwingPercent = 50; // Straight
+const int maxSwingPercent = 75; // Off-beat three quarters into the pair
+
+enum GrooveType
+{
+    GROOVE_STRAIGHT,
+    GROOVE_SWING,     // Pairs, amount from swingPercent
+    GROOVE_SHUFFLE,   // Triplet feel
+    GROOVE_MPC16,     // MPC-style 16ths: swung off-beats, slightly heavier at the end of each beat pair
+    GROOVE_LAID_BACK, // Backbeat steps dragged behind the grid
+    GROOVE_PUSH,      // Off-beats pushed ahead of the grid
+    GROOVE_COUNT      // must be last
+};
+
+extern const char *grooveNames[GROOVE_COUNT];
+
+struct GrooveTable
+{
+    int32_t offsetUs[maxGrooveSteps]; // Offset from the grid per step position
+    uint8_t length;                   // Steps in the groove cycle
+    uint32_t leadUs;                  // Most negative offset, as a lead ahead of the grid (0 = none)
+};
+
+// Resolve a groove for the current step length (whole microseconds)
+void buildGrooveTable(GrooveTable &table, GrooveType type, int swingPercent, uint32_t stepUs);
@@ -0,0 +1,81 @@
+#include "Humanize.h"
+
+const char *humanizeProfileNames[HUMANIZE_PROFILE_COUNT] = {"UNIFORM", "GAUSSIAN", "DRIFT"};
+
+// Upper half of the standard normal quantiles at (i + 0.5) / 256, scaled so
+// the outermost (2.89 sigma) is 32767; the sign comes from a separate bit
+static const uint16_t gaussianQuantiles[128] = {
+    56, 167, 278, 389, 500, 612, 723, 835, 946, 1058, 1170, 1281, 1393, 1505, 1618, 1730,
+    1843, 1955, 2068, 2181, 2295, 2408, 2522, 2636, 2751, 2865, 2980, 3095, 3211, 3327, 3443, 3560,
+    3677, 3794, 3912, 4030, 4149, 4268, 4387, 4507, 4628, 4749, 4871, 4993, 5116, 5239, 5363, 5488,
+    5613, 5739, 5866, 5993, 6121, 6250, 6380, 6511, 6642, 6774, 6908, 7042, 7177, 7314, 7451, 7589,
+    7729, 7870, 8012, 8155, 8299, 8445, 8593, 8741, 8892, 9044, 9197, 9352, 9509, 9668, 9829, 9992,
+    10156, 10323, 10493, 10664, 10838, 11015, 11194, 11376, 11562, 11750, 11941, 12137, 12335, 12538, 12744, 12955,
+    13171, 13391, 13617, 13848, 14085, 14328, 14578, 14835, 15100, 15373, 15656, 15949, 16253, 16569, 16898, 17242,
+    17603, 17982, 18383, 18808, 19261, 19747, 20272, 20844, 21475, 22180, 22983, 23920, 25056, 26517, 28621, 32767};
+
+static const int32_t driftPoleQ15 = 29491; // 0.9: about ten steps of memory
+static const int32_t driftGainQ15 = 14283; // sqrt(1 - 0.9^2), keeps the drift as wide as a single draw
+
+static uint32_t rngState = 0x2545F491;
+static int32_t driftQ15 = 0;
+
+void humanizeSeed(uint32_t seed)
+{
+    rngState = seed ? seed : 0x2545F491;
+    driftQ15 = 0;
+}
+
+static uint32_t nextRandom()
+{
+    // xorshift32
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+// Standard normal draw, Q15 of the table's outermost quantile
+static int32_t gaussianQ15()
+{
+    uint32_t r = nextRandom();
+    int32_t q = gaussianQuantiles[r >> 25];
+    return (r & 1) ? -q : q;
+}
+
+int32_t humanizeOffset(HumanizeProfile profile, uint32_t rangeUs, uint32_t stepUs)
+{
+    if (rangeUs == 0)
+        return 0;
+
+    int32_t offset;
+    switch (profile)
+    {
+    case HUMANIZE_GAUSSIAN:
+        offset = static_cast<int32_t>((static_cast<int64_t>(gaussianQ15()) * rangeUs) >> 15);
+        break;
+    case HUMANIZE_DRIFT:
+        driftQ15 = static_cast<int32_t>((static_cast<int64_t>(driftPoleQ15) * driftQ15 +
+                                         static_cast<int64_t>(driftGainQ15) * gaussianQ15()) >> 15);
+        offset = static_cast<int32_t>((static_cast<int64_t>(driftQ15) * rangeUs) >> 15);
+        break;
+    default:
+        offset = static_cast<int32_t>((static_cast<uint64_t>(nextRandom()) * (2 * static_cast<uint64_t>(rangeUs) + 1)) >> 32) -
+                 static_cast<int32_t>(rangeUs);
+        break;
+    }
+
+    // Within the range (drift can wander past it), so the scheduler's render
+    // lead always covers an early draw; and strictly inside a quarter step,
+    // so neighbours never cross
+    int32_t bound = static_cast<int32_t>(stepUs / 4);
+    if (bound > 0)
+        --bound;
+    if (rangeUs < static_cast<uint32_t>(bound))
+        bound = static_cast<int32_t>(rangeUs);
+    if (offset > bound)
+        offset = bound;
+    else if (offset < -bound)
+        offset = -bound;
+    return offset;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+
+// --- HUMANIZE ---
+// Timing humanize drawn per rendered step. Uniform spreads offsets evenly
+// over the range; Gaussian takes a bell curve over the same range from a
+// precomputed inverse-CDF table; Drift runs that through a one-pole filter,
+// so the timing wanders slowly ahead and behind like a player instead of
+// jumping step to step. A draw is one xorshift step plus a table lookup.
+// Offsets never exceed a quarter step either way, so even on top of full
+// swing consecutive steps can meet but never swap places.
+
+enum HumanizeProfile
+{
+    HUMANIZE_UNIFORM,
+    HUMANIZE_GAUSSIAN,
+    HUMANIZE_DRIFT,
+    HUMANIZE_PROFILE_COUNT // must be last
+};
+
+extern const char *humanizeProfileNames[HUMANIZE_PROFILE_COUNT];
+
+void humanizeSeed(uint32_t seed);
+
+// Offset from the grid for the next step: spread over +-rangeUs, never beyond
+// it or a quarter of the step
+int32_t humanizeOffset(HumanizeProfile profile, uint32_t rangeUs, uint32_t stepUs);
@@ -0,0 +1,24 @@
+#include "JitterHistogram.h"
+
+const uint32_t jitterBucketUpperUs[jitterBucketCount - 1] = {10, 25, 50, 100, 250, 500, 1000, 2000, 5000, 10000};
+
+void JitterHistogram::record(uint32_t lateUs)
+{
+    int bucket = 0;
+    while (bucket < jitterBucketCount - 1 && lateUs > jitterBucketUpperUs[bucket])
+        ++bucket;
+    ++buckets[bucket];
+    ++count;
+    totalUs += lateUs;
+    if (lateUs > maxUs)
+        maxUs = lateUs;
+}
+
+void JitterHistogram::reset()
+{
+    for (int i = 0; i < jitterBucketCount; ++i)
+        buckets[i] = 0;
+    count = 0;
+    maxUs = 0;
+    totalUs = 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+
+// --- EMISSION JITTER HISTOGRAM ---
+// How late each note-on left the box: actual departure time minus grid time,
+// counted into fixed buckets in RAM. Recording is a short scan and a few adds,
+// cheap enough for the dispatcher's timer context.
+
+const int jitterBucketCount = 11;
+
+// Inclusive upper bound of each bucket in microseconds; the last bucket takes the rest
+extern const uint32_t jitterBucketUpperUs[jitterBucketCount - 1];
+
+struct JitterHistogram
+{
+    uint32_t buckets[jitterBucketCount];
+    uint32_t count;
+    uint32_t maxUs;
+    uint64_t totalUs;
+
+    void record(uint32_t lateUs);
+    void reset();
+    uint32_t averageUs() const { return count ? static_cast<uint32_t>(totalUs / count) : 0; }
+};
@@ -0,0 +1,201 @@
+#include "MidiOut.h"
+#include "Timebase.h"
+#include <atomic>
+
+static HardwareSerial *midiPort = nullptr;
+static int uartCapacity = 0; // availableForWrite() of the empty UART
+
+// Filled from loop() and the step timer, drained by whichever services first
+static uint8_t buffer[midiOutBufferSize];
+static size_t head = 0;
+static size_t tail = 0;
+static std::atomic_flag servicing = ATOMIC_FLAG_INIT;
+
+// Marked bytes: queued [markSent, markHead), reached the UART [markTail, markSent)
+struct MidiOutMark
+{
+    size_t position; // Buffer index of the byte
+    uint64_t tag;
+    uint64_t departedUs;
+};
+
+// Note-offs that found the buffer full: status byte by note, 0 if none. They
+// go out before anything else is queued, so no note-on can overtake one.
+static uint8_t pendingRelease[128];
+static size_t pendingReleaseCount = 0;
+
+static MidiOutMark marks[midiOutMarkCapacity];
+static size_t markHead = 0;
+static size_t markSent = 0; // Advanced by the servicer only
+static size_t markTail = 0;
+
+#ifdef ARDUINO
+static portMUX_TYPE bufferMux = portMUX_INITIALIZER_UNLOCKED;
+#define MIDI_OUT_LOCK() portENTER_CRITICAL(&bufferMux)
+#define MIDI_OUT_UNLOCK() portEXIT_CRITICAL(&bufferMux)
+#else
+#define MIDI_OUT_LOCK()
+#define MIDI_OUT_UNLOCK()
+#endif
+
+void midiOutBegin(HardwareSerial &port)
+{
+    midiPort = &port;
+    uartCapacity = port.availableForWrite();
+}
+
+// Copy a message in if the buffer then holds at most limit bytes; optionally
+// mark its first byte with tag. Call with the lock held.
+static bool copyMessage(const uint8_t *bytes, size_t length, size_t limit, const uint64_t *tag, bool &marked)
+{
+    if (head - tail + length > limit)
+        return false;
+    if (tag && markHead - markTail < midiOutMarkCapacity)
+    {
+        marks[markHead & (midiOutMarkCapacity - 1)] = {head, *tag, 0};
+        ++markHead;
+        marked = true;
+    }
+    for (size_t i = 0; i < length; ++i)
+        buffer[(head + i) & (midiOutBufferSize - 1)] = bytes[i];
+    head += length;
+    return true;
+}
+
+// Move waiting note-offs into the buffer as far as they fit. Lock held.
+static void queuePendingReleases()
+{
+    for (uint8_t note = 0; pendingReleaseCount && note < 128; ++note)
+    {
+        if (!pendingRelease[note])
+            continue;
+        const uint8_t message[] = {pendingRelease[note], note, 0};
+        bool marked;
+        if (!copyMessage(message, sizeof(message), midiOutBufferSize, nullptr, marked))
+            return;
+        pendingRelease[note] = 0;
+        --pendingReleaseCount;
+    }
+}
+
+// Queue a message outside the note-off reserve, unless note-offs are waiting
+static bool queueMessage(const uint8_t *bytes, size_t length, const uint64_t *tag, bool &marked)
+{
+    marked = false;
+    MIDI_OUT_LOCK();
+    bool queued = !pendingReleaseCount && copyMessage(bytes, length, midiOutBufferSize - midiOutReservedBytes, tag, marked);
+    MIDI_OUT_UNLOCK();
+    return queued;
+}
+
+bool midiOutWrite(uint8_t byte)
+{
+    return midiOutWriteMessage(&byte, 1);
+}
+
+bool midiOutWriteMessage(const uint8_t *bytes, size_t length)
+{
+    bool marked;
+    bool queued = queueMessage(bytes, length, nullptr, marked);
+    midiOutService();
+    return queued;
+}
+
+bool midiOutWriteMarked(const uint8_t *bytes, size_t length, uint64_t tag)
+{
+    bool marked;
+    queueMessage(bytes, length, &tag, marked);
+    midiOutService();
+    return marked;
+}
+
+void midiOutWriteRelease(uint8_t status, uint8_t note)
+{
+    if (!midiPort)
+        return;
+    const uint8_t message[] = {status, note, 0};
+    bool marked;
+    note &= 0x7F;
+    MIDI_OUT_LOCK();
+    queuePendingReleases();
+    if (pendingReleaseCount || !copyMessage(message, sizeof(message), midiOutBufferSize, nullptr, marked))
+    {
+        // Reserve full too: hold it for the next service pass. A second off
+        // for the same note while one waits adds nothing.
+        if (!pendingRelease[note])
+            ++pendingReleaseCount;
+        pendingRelease[note] = status;
+    }
+    MIDI_OUT_UNLOCK();
+    midiOutService();
+}
+
+bool midiOutDeparted(uint64_t &tag, uint64_t &departedUs)
+{
+    bool departed = false;
+    MIDI_OUT_LOCK();
+    if (markTail != markSent)
+    {
+        const MidiOutMark &mark = marks[markTail & (midiOutMarkCapacity - 1)];
+        tag = mark.tag;
+        departedUs = mark.departedUs;
+        ++markTail;
+        departed = true;
+    }
+    MIDI_OUT_UNLOCK();
+    return departed;
+}
+
+void midiOutRealtime(uint8_t byte)
+{
+    if (midiPort)
+        midiPort->write(byte);
+}
+
+bool midiOutService()
+{
+    if (!midiPort)
+        return false;
+    // One servicer at a time, so bytes leave in order
+    if (servicing.test_and_set(std::memory_order_acquire))
+        return true;
+
+    MIDI_OUT_LOCK();
+    queuePendingReleases();
+    MIDI_OUT_UNLOCK();
+
+    bool pending;
+    for (;;)
+    {
+        if (uartCapacity - midiPort->availableForWrite() >= midiOutUartDepth)
+        {
+            pending = head != tail;
+            break;
+        }
+        uint8_t byte;
+        bool marked = false;
+        MIDI_OUT_LOCK();
+        pending = head != tail;
+        if (pending)
+        {
+            marked = markSent != markHead && marks[markSent & (midiOutMarkCapacity - 1)].position == tail;
+            byte = buffer[tail & (midiOutBufferSize - 1)];
+            ++tail;
+        }
+        MIDI_OUT_UNLOCK();
+        if (!pending)
+            break;
+        midiPort->write(byte);
+        if (marked)
+        {
+            uint64_t nowUs = timebaseNowUs();
+            MIDI_OUT_LOCK();
+            marks[markSent & (midiOutMarkCapacity - 1)].departedUs = nowUs;
+            ++markSent;
+            MIDI_OUT_UNLOCK();
+        }
+    }
+
+    servicing.clear(std::memory_order_release);
+    return pending || pendingReleaseCount;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <Arduino.h>
+
+// --- MIDI OUT ---
+// DIN MIDI output with realtime priority. Channel and SysEx bytes go through
+// a software FIFO that keeps only a couple of bytes in the UART, so clock and
+// Start/Stop bytes never wait behind a burst of chord notes. Realtime bytes
+// may legally interleave anywhere, even mid-message, and go straight out.
+// Channel messages are queued whole or not at all, so an overflow never
+// leaves half a message (and broken running status) on the wire. Note-offs
+// have space of their own, and any that do not fit wait by note until the
+// next service pass; they are never dropped.
+
+const size_t midiOutBufferSize = 256; // Power of two
+const int midiOutUartDepth = 2;       // Bytes allowed in the UART ahead of a realtime byte
+const uint32_t midiOutByteUs = 320;   // One byte on the wire at 31250 baud
+const size_t midiOutMarkCapacity = 32; // Marked messages in flight, power of two
+const size_t midiOutReservedBytes = 48; // Kept free for note-offs (16 of them)
+
+void midiOutBegin(HardwareSerial &port);
+
+// Queue a channel/SysEx byte; returns false if the buffer is full
+bool midiOutWrite(uint8_t byte);
+
+// Queue a whole channel/SysEx message; returns false, with nothing queued,
+// if it does not fit outside the note-off reserve or note-offs are waiting
+bool midiOutWriteMessage(const uint8_t *bytes, size_t length);
+
+// Same, and time when the status byte reaches the UART: midiOutDeparted()
+// hands the tag back with that time. Returns true only if queued and marked.
+bool midiOutWriteMarked(const uint8_t *bytes, size_t length, uint64_t tag);
+
+// Queue a note-off (status 0x8n): it may use the reserve, and beyond that is
+// held until midiOutService() finds room rather than dropped (a lost
+// note-off leaves a note stuck). Never blocks.
+void midiOutWriteRelease(uint8_t status, uint8_t note);
+
+// Next marked message whose status byte has reached the UART, oldest first
+bool midiOutDeparted(uint64_t &tag, uint64_t &departedUs);
+
+// Send a realtime byte (0xF8-0xFF) ahead of anything queued
+void midiOutRealtime(uint8_t byte);
+
+// Move queued bytes into the UART as it drains. Call often (loop and the
+// step timer); returns true while bytes or note-offs are still waiting.
+bool midiOutService();
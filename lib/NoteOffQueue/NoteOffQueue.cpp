@@ -0,0 +1,61 @@
+#include "NoteOffQueue.h"
+
+bool NoteOffQueue::push(uint64_t timeUs, uint8_t voice)
+{
+    if (count == noteOffQueueCapacity)
+        return false;
+    heap[count] = {timeUs, voice};
+    siftUp(count++);
+    return true;
+}
+
+bool NoteOffQueue::popDue(uint64_t nowUs, PendingNoteOff &out)
+{
+    if (count == 0 || heap[0].timeUs > nowUs)
+        return false;
+    return popEarliest(out);
+}
+
+bool NoteOffQueue::popEarliest(PendingNoteOff &out)
+{
+    if (count == 0)
+        return false;
+    out = heap[0];
+    heap[0] = heap[--count];
+    siftDown(0);
+    return true;
+}
+
+void NoteOffQueue::siftUp(size_t i)
+{
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent].timeUs <= heap[i].timeUs)
+            break;
+        PendingNoteOff tmp = heap[parent];
+        heap[parent] = heap[i];
+        heap[i] = tmp;
+        i = parent;
+    }
+}
+
+void NoteOffQueue::siftDown(size_t i)
+{
+    for (;;)
+    {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < count && heap[left].timeUs < heap[smallest].timeUs)
+            smallest = left;
+        if (right < count && heap[right].timeUs < heap[smallest].timeUs)
+            smallest = right;
+        if (smallest == i)
+            break;
+        PendingNoteOff tmp = heap[smallest];
+        heap[smallest] = heap[i];
+        heap[i] = tmp;
+        i = smallest;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// --- NOTE-OFF QUEUE ---
+// Fixed-capacity min-heap of pending note-offs keyed by time. Lets gates run
+// past the next step (legato/ties) and steps overlap, with note-on and
+// note-off scheduling independent of each other. No allocation.
+
+const size_t noteOffQueueCapacity = 64;
+
+struct PendingNoteOff
+{
+    uint64_t timeUs;
+    uint8_t voice; // Output voice whose note-on this closes
+};
+
+class NoteOffQueue
+{
+public:
+    // Returns false when full (the caller should release the earliest first)
+    bool push(uint64_t timeUs, uint8_t voice);
+    // Pop the earliest entry if it is due at nowUs
+    bool popDue(uint64_t nowUs, PendingNoteOff &out);
+    // Pop the earliest entry regardless of time
+    bool popEarliest(PendingNoteOff &out);
+
+    void clear() { count = 0; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == noteOffQueueCapacity; }
+    size_t size() const { return count; }
+    uint64_t nextTimeUs() const { return heap[0].timeUs; } // Only valid when not empty
+
+private:
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+
+    PendingNoteOff heap[noteOffQueueCapacity];
+    size_t count = 0;
+};
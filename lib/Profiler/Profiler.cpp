@@ -0,0 +1,114 @@
+#include "Profiler.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdio.h>
+#ifdef ARP_PROFILE
+#include <chrono>
+#endif
+#endif
+
+const char *profileStageNames[PROFILE_STAGE_COUNT] = {
+    "Clear button",
+    "Encoder",
+    "MIDI in",
+    "USB in",
+    "Serial commands",
+    "Chord input",
+    "Chord pattern",
+    "Random chords",
+    "Step render",
+    "Step emission",
+    "LED",
+    "Debug print",
+    "Dispatch (timer)"};
+
+#ifdef ARP_PROFILE
+
+struct ProfileStats
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+};
+
+static ProfileStats profileStats[PROFILE_STAGE_COUNT];
+
+uint32_t profileNow()
+{
+#ifdef ARDUINO
+    return ESP.getCycleCount();
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+#endif
+}
+
+void profileRecord(ProfileStage stage, uint32_t elapsed)
+{
+    ProfileStats &stats = profileStats[stage];
+    if (stats.count == 0 || elapsed < stats.min)
+        stats.min = elapsed;
+    if (elapsed > stats.max)
+        stats.max = elapsed;
+    stats.total += elapsed;
+    ++stats.count;
+}
+
+void profilerReport()
+{
+#ifdef ARDUINO
+    Serial.print("Profile (cycles @ ");
+    Serial.print(ESP.getCpuFreqMHz());
+    Serial.println(" MHz): stage count min avg max");
+#else
+    printf("Profile (ns): stage count min avg max\n");
+#endif
+    for (int i = 0; i < PROFILE_STAGE_COUNT; ++i)
+    {
+        const ProfileStats &stats = profileStats[i];
+        if (stats.count == 0)
+            continue;
+#ifdef ARDUINO
+        Serial.print("  ");
+        Serial.print(profileStageNames[i]);
+        Serial.print(": ");
+        Serial.print(stats.count);
+        Serial.print(" ");
+        Serial.print(stats.min);
+        Serial.print(" ");
+        Serial.print(static_cast<uint32_t>(stats.total / stats.count));
+        Serial.print(" ");
+        Serial.println(stats.max);
+#else
+        printf("  %s: %u %u %u %u\n", profileStageNames[i], (unsigned)stats.count, (unsigned)stats.min,
+               (unsigned)(stats.total / stats.count), (unsigned)stats.max);
+#endif
+    }
+}
+
+void profilerReset()
+{
+    for (int i = 0; i < PROFILE_STAGE_COUNT; ++i)
+        profileStats[i] = {0, 0, 0, 0};
+}
+
+#else
+
+void profilerReport()
+{
+#ifdef ARDUINO
+    Serial.println("Profiler disabled (build with -DARP_PROFILE)");
+#else
+    printf("Profiler disabled (build with -DARP_PROFILE)\n");
+#endif
+}
+
+void profilerReset()
+{
+}
+
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+#include <stdint.h>
+
+// --- PROFILER ---
+// Per-stage cycle counts for the loop() pipeline: min/avg/max and call count
+// per stage. Uses ESP.getCycleCount() on target and a steady clock (ns) on
+// host. Build with -DARP_PROFILE to enable; without it the probes compile to
+// nothing and only a stub report remains.
+
+enum ProfileStage
+{
+    PROFILE_CLEAR_BUTTON,
+    PROFILE_ENCODER,
+    PROFILE_MIDI_IN,
+    PROFILE_USB_IN,
+    PROFILE_SERIAL_COMMANDS,
+    PROFILE_CHORD_INPUT,    // Held-notes rebuild, chord capture, recognition and fill
+    PROFILE_CHORD_PATTERN,  // Range shift/stretch, pattern, bias, MODE_BAR
+    PROFILE_RANDOM_CHORDS,  // Random chord steps and voice leading
+    PROFILE_STEP_RENDER,    // Tempo, groove and step table render
+    PROFILE_STEP_EMISSION,  // Publish: render ahead into the event queue
+    PROFILE_LED,
+    PROFILE_DEBUG_PRINT,
+    PROFILE_DISPATCH,       // Timer callback (not part of loop())
+    PROFILE_STAGE_COUNT     // must be last
+};
+
+extern const char *profileStageNames[PROFILE_STAGE_COUNT];
+
+// Print every stage that has run, then optionally clear
+void profilerReport();
+void profilerReset();
+
+#ifdef ARP_PROFILE
+
+uint32_t profileNow();
+void profileRecord(ProfileStage stage, uint32_t elapsed);
+
+// Times the enclosing scope
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfileStage stage) : stage(stage), start(profileNow()) {}
+    ~ProfileScope() { profileRecord(stage, profileNow() - start); }
+
+private:
+    ProfileStage stage;
+    uint32_t start;
+};
+
+// Times consecutive stages of one scope: each next() closes the running stage
+class ProfileLap
+{
+public:
+    explicit ProfileLap(ProfileStage stage) : stage(stage), start(profileNow()) {}
+    ~ProfileLap() { profileRecord(stage, profileNow() - start); }
+    void next(ProfileStage nextStage)
+    {
+        uint32_t now = profileNow();
+        profileRecord(stage, now - start);
+        stage = nextStage;
+        start = now;
+    }
+
+private:
+    ProfileStage stage;
+    uint32_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(stage)
+#define PROFILE_LAP_BEGIN(lap, stage) ProfileLap lap(stage)
+#define PROFILE_LAP(lap, stage) lap.next(stage)
+
+#else
+
+#define PROFILE_SCOPE(stage)
+#define PROFILE_LAP_BEGIN(lap, stage)
+#define PROFILE_LAP(lap, stage)
+
+#endif
@@ -0,0 +1,62 @@
+#include "ScaleQuantizer.h"
+
+const char *scaleNames[SCALE_COUNT] = {
+    "Chromatic", "Major", "Minor", "Harmonic Minor", "Dorian", "Phrygian", "Lydian", "Mixolydian",
+    "Pentatonic Major", "Pentatonic Minor", "Blues"};
+
+// Pitch-class masks relative to the root (bit 0 = root), indexed by ScaleType
+static constexpr uint16_t scaleMasks[SCALE_COUNT] = {
+    0x0FFF, // Chromatic
+    0x0AB5, // Major:            0 2 4 5 7 9 11
+    0x05AD, // Minor:            0 2 3 5 7 8 10
+    0x09AD, // Harmonic minor:   0 2 3 5 7 8 11
+    0x06AD, // Dorian:           0 2 3 5 7 9 10
+    0x05AB, // Phrygian:         0 1 3 5 7 8 10
+    0x0AD5, // Lydian:           0 2 4 6 7 9 11
+    0x06B5, // Mixolydian:       0 2 4 5 7 9 10
+    0x0295, // Pentatonic major: 0 2 4 7 9
+    0x04A9, // Pentatonic minor: 0 3 5 7 10
+    0x04E9  // Blues:            0 3 5 6 7 10
+};
+
+static constexpr bool inScale(int scale, int root, int note)
+{
+    return (scaleMasks[scale] >> ((note - root + 120) % 12)) & 1;
+}
+
+// Nearest in-scale note; ties resolve downwards, results stay within 0..127
+static constexpr uint8_t quantizeNote(int scale, int root, int note)
+{
+    for (int distance = 0; distance < 12; ++distance)
+    {
+        if (note - distance >= 0 && inScale(scale, root, note - distance))
+            return static_cast<uint8_t>(note - distance);
+        if (note + distance <= 127 && inScale(scale, root, note + distance))
+            return static_cast<uint8_t>(note + distance);
+    }
+    return static_cast<uint8_t>(note);
+}
+
+struct ScaleQuantizeTables
+{
+    uint8_t map[SCALE_COUNT][12][128];
+};
+
+static constexpr ScaleQuantizeTables makeScaleQuantizeTables()
+{
+    ScaleQuantizeTables tables{};
+    for (int scale = 0; scale < SCALE_COUNT; ++scale)
+        for (int root = 0; root < 12; ++root)
+            for (int note = 0; note < 128; ++note)
+                tables.map[scale][root][note] = quantizeNote(scale, root, note);
+    return tables;
+}
+
+static constexpr ScaleQuantizeTables scaleQuantizeTables = makeScaleQuantizeTables();
+
+const uint8_t *scaleQuantizeTable(ScaleType scale, uint8_t root)
+{
+    if (scale < 0 || scale >= SCALE_COUNT)
+        scale = SCALE_CHROMATIC;
+    return scaleQuantizeTables.map[scale][root % 12];
+}
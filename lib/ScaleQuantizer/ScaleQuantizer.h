@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+
+// --- SCALE QUANTIZER ---
+// A 128-entry note->note table for every scale and root, generated at compile
+// time. Quantizing an outgoing note is a single byte load.
+enum ScaleType
+{
+    SCALE_CHROMATIC, // Pass-through (quantizer off)
+    SCALE_MAJOR,
+    SCALE_MINOR,
+    SCALE_HARMONIC_MINOR,
+    SCALE_DORIAN,
+    SCALE_PHRYGIAN,
+    SCALE_LYDIAN,
+    SCALE_MIXOLYDIAN,
+    SCALE_PENTATONIC_MAJOR,
+    SCALE_PENTATONIC_MINOR,
+    SCALE_BLUES,
+    SCALE_COUNT // must be last
+};
+
+extern const char *scaleNames[SCALE_COUNT];
+
+// Quantize table for a scale and root (0..11); index with any MIDI note 0..127
+const uint8_t *scaleQuantizeTable(ScaleType scale, uint8_t root);
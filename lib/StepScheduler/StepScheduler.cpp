@@ -0,0 +1,698 @@
+#include "StepScheduler.h"
+#include "Constants.h"
+#include "Timebase.h"
+#include "Tempo.h"
+#include "TickGrid.h"
+#include "NoteOffQueue.h"
+#include "EventQueue.h"
+#include "Profiler.h"
+#include <atomic>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+
+static esp_timer_handle_t stepTimer = nullptr;
+#else
+// Host build: single-threaded, the simulated timer fires from stepSchedulerSimulate()
+static uint64_t simDeadlineUs = 0;
+static bool simArmed = false;
+#endif
+
+static const uint32_t idlePollUs = 1000; // Re-check interval while the queue is empty
+static const uint32_t minArmUs = 10;     // Shortest delay handed to the timer
+static const uint32_t outputServiceUs = 320; // Re-check while output bytes wait (one DIN byte)
+
+static StepTable stepTables[2];
+static int activeTable = 0;
+static StepOutput stepOutput = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+// Render state, owned by loop()
+static PhaseAccumulator nextStep; // Grid time of the next step, sub-microsecond exact
+static bool gridRunning = false;
+static uint8_t grooveIndex = 0;    // Grid position within the groove cycle
+static NoteOffQueue pendingOffs;   // Gates may outlast the step, so offs are queued by time
+static uint64_t lastRenderedUs = 0; // Keeps the event queue in time order
+static uint32_t outputLatencyUs[maxOutputDestinations] = {};
+static uint64_t lastQueuedUs[maxOutputDestinations] = {}; // ...and each latency-shifted copy
+static uint8_t nextVoice = 0;
+
+// External clock, owned by loop()
+static const ClockTracker *clockSource = nullptr;
+static bool tickLocked = false;               // Step times come from clock ticks
+static TickPosition nextStepTick;             // Tick position of the next step
+static const TickDivision *tickDivision = nullptr;
+static ClockRatio appliedRatio = CLOCK_RATIO_NORMAL; // Ratio the tick grid runs at
+static uint32_t tickOrigin = 0;               // Beat the step grid counts from
+static bool ratioSwitchPending = false;       // clockRatio changed: switch at ratioSwitchTick
+static uint32_t ratioSwitchTick = 0;
+
+// Transport, owned by loop()
+static bool transportStopped = false;
+static bool relocatePending = false; // Next render derives the position from startTick
+static uint32_t startTick = 0;
+static bool alignPending = false;    // Next render puts a downbeat at alignDownbeatUs
+static uint64_t alignDownbeatUs = 0;
+
+// Set by loop(), carried out by the dispatcher: drop queued events, silence sounding notes
+static volatile bool flushRequested = false;
+
+// Clock master, owned by loop(). Ticks of the current step segment
+// [segmentStartUs, nextStep.us) are interpolated from the step grid.
+static bool clockMaster = false;
+static bool segmentOpen = false;             // Start sent, clock running
+static uint64_t segmentStartUs = 0;          // Grid time of the last rendered step
+static TickPosition segmentTick;             // Its tick position
+static const TickDivision *segmentDivision = nullptr;
+static TickPosition masterStepTick;          // Tick position of the next step
+static uint32_t nextClockTick = 0;
+static uint64_t lastClockUs[maxOutputDestinations] = {}; // Keeps each clock queue in time order
+
+// Shared between the renderer (producer) and the dispatcher (consumer)
+static EventQueue eventQueues[maxOutputDestinations]; // One schedule per destination
+static EventQueue clockQueues[maxOutputDestinations]; // Realtime bytes, dispatched ahead of notes
+
+// Dispatch state, owned by the timer callback, per destination
+static uint8_t voiceNote[maxOutputDestinations][256];     // Output note each voice's note-on was sent as
+static uint8_t soundingCount[maxOutputDestinations][128]; // Overlapping instances per output note
+static volatile uint32_t dispatchedCount = 0;
+static volatile uint32_t lateCount = 0;
+static volatile uint32_t maxDepth = 0;
+static JitterHistogram jitter;
+static volatile bool jitterResetRequested = false;
+static JitterHistogram jitterSnapshot;                   // Copied by the dispatcher on request
+static std::atomic<bool> jitterSnapshotRequested{false}; // Cleared once jitterSnapshot is written
+
+static void armStepTimer(uint64_t delayUs)
+{
+    if (delayUs < minArmUs)
+        delayUs = minArmUs;
+#ifdef ARDUINO
+    esp_timer_start_once(stepTimer, delayUs);
+#else
+    simDeadlineUs = timebaseNowUs() + delayUs;
+    simArmed = true;
+#endif
+}
+
+// --- DISPATCHER (timer context) ---
+static void recordJitter(uint64_t dueUs, uint64_t sentUs)
+{
+    jitter.record(sentUs > dueUs ? static_cast<uint32_t>(sentUs - dueUs) : 0);
+}
+
+// Buffered note-ons that have left since the last pass
+static void recordDepartures()
+{
+    uint64_t dueUs;
+    uint64_t departedUs;
+    while (stepOutput.departed && stepOutput.departed(dueUs, departedUs))
+        recordJitter(dueUs, departedUs);
+}
+
+static void dispatchEvent(uint8_t destination, const OutputEvent &event)
+{
+    uint8_t *sounding = soundingCount[destination];
+    if (event.type == EVENT_NOTE_ON)
+    {
+        uint8_t note = stepOutput.mapNote ? stepOutput.mapNote(event.note) : event.note;
+        // Retrigger: close a still-sounding instance before the new note-on
+        if (sounding[note] > 0)
+            stepOutput.noteOff(destination, note);
+        ++sounding[note];
+        voiceNote[destination][event.voice] = note;
+        if (!stepOutput.noteOn(destination, note, event.velocity, event.dueUs))
+            recordJitter(event.dueUs, timebaseNowUs());
+    }
+    else
+    {
+        // The note-off goes out when the last overlapping instance ends
+        uint8_t note = voiceNote[destination][event.voice];
+        if (sounding[note] > 0 && --sounding[note] == 0)
+            stepOutput.noteOff(destination, note);
+    }
+}
+
+// Drop everything queued and release every sounding note
+static void flushOutput()
+{
+    OutputEvent event;
+    for (uint8_t d = 0; d < maxOutputDestinations; ++d)
+    {
+        while (eventQueues[d].peek(event))
+            eventQueues[d].pop();
+        for (int note = 0; note < 128; ++note)
+        {
+            if (soundingCount[d][note] > 0)
+            {
+                soundingCount[d][note] = 0;
+                stepOutput.noteOff(d, note);
+            }
+        }
+    }
+}
+
+// Earliest event across the destination schedules; -1 if all are empty
+static int peekEarliest(EventQueue *queues, OutputEvent &event)
+{
+    int destination = -1;
+    OutputEvent candidate;
+    for (uint8_t d = 0; d < maxOutputDestinations; ++d)
+    {
+        if (queues[d].peek(candidate) && (destination < 0 || candidate.timeUs < event.timeUs))
+        {
+            event = candidate;
+            destination = d;
+        }
+    }
+    return destination;
+}
+
+static void stepTimerCallback(void *)
+{
+    PROFILE_SCOPE(PROFILE_DISPATCH);
+    if (flushRequested)
+    {
+        flushOutput();
+        flushRequested = false;
+    }
+    if (jitterResetRequested)
+    {
+        jitter.reset();
+        jitterResetRequested = false;
+    }
+    if (jitterSnapshotRequested.load(std::memory_order_relaxed))
+    {
+        jitterSnapshot = jitter;
+        jitterSnapshotRequested.store(false, std::memory_order_release);
+    }
+
+    uint64_t now = timebaseNowUs();
+    OutputEvent event;
+    OutputEvent clock;
+    for (;;)
+    {
+        int destination = peekEarliest(eventQueues, event);
+        bool eventDue = destination >= 0 && event.timeUs <= now;
+        int clockDestination = peekEarliest(clockQueues, clock);
+        bool clockDue = clockDestination >= 0 && clock.timeUs <= now;
+        if (clockDue && (!eventDue || clock.timeUs <= event.timeUs))
+        {
+            // Clock preempts notes due at the same time
+            clockQueues[clockDestination].pop();
+            stepOutput.realtime(clockDestination, clock.note);
+        }
+        else if (eventDue)
+        {
+            eventQueues[destination].pop();
+            dispatchEvent(destination, event);
+            ++dispatchedCount;
+            if (now > event.dueUs + lateEventUs)
+                ++lateCount;
+        }
+        else
+        {
+            break;
+        }
+        now = timebaseNowUs();
+    }
+    bool outputPending = stepOutput.serviceOutput && stepOutput.serviceOutput();
+    recordDepartures();
+
+    // Aim straight at an event just past the idle poll, or the poll would land
+    // too close to it and the minArmUs clamp would make it late
+    uint64_t wakeUs = now + (outputPending ? outputServiceUs : idlePollUs);
+    if (peekEarliest(eventQueues, event) >= 0 && event.timeUs < wakeUs + minArmUs)
+        wakeUs = event.timeUs;
+    if (peekEarliest(clockQueues, clock) >= 0 && clock.timeUs < wakeUs + minArmUs)
+        wakeUs = clock.timeUs;
+    armStepTimer(wakeUs > now ? wakeUs - now : 0);
+}
+
+// --- RENDERER (loop context) ---
+// Room left in the fullest destination schedule
+static size_t queueSpace(const EventQueue *queues = eventQueues)
+{
+    size_t space = eventQueueCapacity;
+    for (uint8_t d = 0; d < maxOutputDestinations; ++d)
+        if (queues[d].space() < space)
+            space = queues[d].space();
+    return space;
+}
+
+// Queue an event on every destination, each copy early by that output's latency
+static bool pushEvent(OutputEvent event)
+{
+    if (event.timeUs < lastRenderedUs)
+        event.timeUs = lastRenderedUs;
+    if (queueSpace() == 0)
+        return false;
+    lastRenderedUs = event.timeUs;
+    for (uint8_t d = 0; d < maxOutputDestinations; ++d)
+    {
+        OutputEvent shifted = event;
+        shifted.timeUs = event.timeUs > outputLatencyUs[d] ? event.timeUs - outputLatencyUs[d] : 0;
+        shifted.dueUs = event.dueUs > outputLatencyUs[d] ? event.dueUs - outputLatencyUs[d] : 0;
+        if (shifted.timeUs < lastQueuedUs[d])
+            shifted.timeUs = lastQueuedUs[d]; // A latency change never reorders a schedule
+        eventQueues[d].push(shifted);
+        lastQueuedUs[d] = shifted.timeUs;
+        uint32_t depth = eventQueues[d].depth();
+        if (depth > maxDepth)
+            maxDepth = depth;
+    }
+    return true;
+}
+
+// Move pending note-offs due before timeUs into the event queues, leaving
+// reservedSpace free for note-ons still to be rendered
+static void flushNoteOffs(uint64_t timeUs, size_t reservedSpace = 0)
+{
+    PendingNoteOff off;
+    while (!pendingOffs.empty() && pendingOffs.nextTimeUs() <= timeUs && queueSpace() > reservedSpace)
+    {
+        pendingOffs.popEarliest(off);
+        pushEvent({off.timeUs, off.timeUs, EVENT_NOTE_OFF, 0, 0, off.voice});
+    }
+}
+
+// Tick division for the current steps per bar and time signature
+static const TickDivision &currentTickDivision()
+{
+    return tickDivisionFor(stepsPerBar, barTicks);
+}
+
+// ...and as followed from an external clock, through the applied clock ratio
+static const TickDivision &followTickDivision()
+{
+    return tickDivisionFor(stepsPerBar, barTicks, appliedRatio);
+}
+
+// --- CLOCK MASTER (loop context) ---
+// Queue a realtime byte on every destination, each early by its latency like the notes
+static void pushClock(uint64_t timeUs, uint8_t status)
+{
+    if (queueSpace(clockQueues) == 0)
+        return;
+    for (uint8_t d = 0; d < maxOutputDestinations; ++d)
+    {
+        uint64_t shiftedUs = timeUs > outputLatencyUs[d] ? timeUs - outputLatencyUs[d] : 0;
+        if (shiftedUs < lastClockUs[d])
+            shiftedUs = lastClockUs[d];
+        clockQueues[d].push({shiftedUs, shiftedUs, EVENT_REALTIME, status, 0, 0});
+        lastClockUs[d] = shiftedUs;
+    }
+}
+
+// Ticks of the current segment that fall before limitUs
+static void renderClockTicks(uint64_t limitUs)
+{
+    uint64_t segmentUs = nextStep.us - segmentStartUs;
+    while (queueSpace(clockQueues) > 0)
+    {
+        // Tick offset from the segment start in 1/barTicks of the step
+        int64_t offset = static_cast<int64_t>(nextClockTick - segmentTick.tick) * segmentDivision->steps -
+                         segmentTick.remainder;
+        if (offset >= segmentDivision->barTicks)
+            break; // Belongs to the next step
+        uint64_t tickUs = segmentStartUs + segmentUs * offset / segmentDivision->barTicks;
+        if (tickUs >= limitUs)
+            break;
+        pushClock(tickUs, 0xF8);
+        ++nextClockTick;
+    }
+}
+
+// Called as each step is rendered: close the previous segment, open this one
+static void clockStep(uint64_t stepUs)
+{
+    if (segmentOpen)
+    {
+        renderClockTicks(UINT64_MAX);
+        if (segmentDivision != &currentTickDivision())
+        {
+            // New step count or meter: carry on from the next whole tick
+            uint32_t tick = masterStepTick.tick + (masterStepTick.remainder ? 1 : 0);
+            masterStepTick = {0, tick, 0};
+        }
+    }
+    else
+    {
+        pushClock(stepUs, 0xFA); // Start: the next tick is the downbeat
+        masterStepTick = {0, 0, 0};
+        nextClockTick = 0;
+        segmentOpen = true;
+    }
+    segmentDivision = &currentTickDivision();
+    segmentStartUs = stepUs;
+    segmentTick = masterStepTick;
+    masterStepTick.advance(*segmentDivision);
+}
+
+static void stopClock(uint64_t nowUs)
+{
+    if (!segmentOpen)
+        return;
+    pushClock(nowUs, 0xFC);
+    segmentOpen = false;
+}
+
+static uint64_t tickPositionUs(const TickPosition &position)
+{
+    return clockSource->tickTimeUs(position.tick, static_cast<float>(position.remainder) / tickDivision->steps);
+}
+
+// Pattern and groove position for a step number counted from the downbeat, O(1)
+static void locateStep(const StepTable &table, uint32_t step)
+{
+    int repeat = table.repeat > 0 ? table.repeat : 1;
+    currentNoteIndex = (step / repeat) % table.size;
+    noteRepeatCounter = step % repeat;
+    if (table.groove && table.groove->length > 0)
+        grooveIndex = step % table.groove->length;
+}
+
+// Internal grid through a future downbeat: the first step from now on, and the
+// pattern position that reaches step 0 on the downbeat
+static void alignToDownbeat(const StepTable &table, uint64_t nowUs)
+{
+    uint64_t periodQ32 = tempoStepPeriodQ32();
+    uint64_t leadUs = alignDownbeatUs > nowUs ? alignDownbeatUs - nowUs : 0;
+    uint32_t stepsBefore = periodQ32 ? static_cast<uint32_t>((leadUs << 32) / periodQ32) : 0;
+    nextStep.reset(alignDownbeatUs - ((stepsBefore * periodQ32) >> 32));
+
+    // Count back from a whole number of pattern, repeat and groove cycles
+    uint32_t cycle = static_cast<uint32_t>(table.size) * (table.repeat > 0 ? table.repeat : 1);
+    if (table.groove && table.groove->length > 0)
+        cycle *= table.groove->length;
+    locateStep(table, (cycle - stepsBefore % cycle) % cycle);
+}
+
+// Align the next step to the first tick boundary from now on
+static void lockToTicks(const StepTable &table)
+{
+    tickDivision = &followTickDivision();
+    uint32_t tick = clockSource->tickCount();
+    nextStepTick = tickPositionAtOrAfter(tick > tickOrigin ? tick - tickOrigin : 0, *tickDivision);
+    nextStepTick.tick += tickOrigin;
+    nextStep.reset(tickPositionUs(nextStepTick));
+    if (relocatePending)
+    {
+        locateStep(table, nextStepTick.step);
+        relocatePending = false;
+    }
+    else if (table.groove && table.groove->length > 0)
+    {
+        grooveIndex = nextStepTick.step % table.groove->length;
+    }
+    tickLocked = true;
+}
+
+// A new clock ratio takes over at the first beat from the next step on. The
+// grid restarts on that beat, so steps stay in phase with the clock.
+static void switchClockRatio()
+{
+    if (clockRatio == appliedRatio)
+    {
+        ratioSwitchPending = false;
+        return;
+    }
+    if (!ratioSwitchPending)
+    {
+        uint32_t tick = nextStepTick.tick + (nextStepTick.remainder ? 1 : 0);
+        ratioSwitchTick = (tick + clockTicksPerBeat - 1) / clockTicksPerBeat * clockTicksPerBeat;
+        ratioSwitchPending = true;
+    }
+    if (nextStepTick.tick < ratioSwitchTick)
+        return;
+    appliedRatio = clockRatio;
+    tickOrigin = ratioSwitchTick;
+    tickDivision = &followTickDivision();
+    nextStepTick = {0, ratioSwitchTick, 0};
+    nextStep.reset(tickPositionUs(nextStepTick));
+    grooveIndex = 0;
+    ratioSwitchPending = false;
+}
+
+static void renderAhead()
+{
+    const StepTable &table = stepTables[activeTable];
+    uint64_t now = timebaseNowUs();
+    uint64_t horizonUs = now + lookaheadUs;
+    // Humanize (up to a quarter step) and groove can pull a step ahead of the grid:
+    // render that much earlier, so an early step still gets the full look-ahead
+    uint32_t quarterStepUs = periodWholeUs(tempoStepPeriodQ32()) / 4;
+    uint32_t renderLeadUs = table.humanizeRangeUs < quarterStepUs ? table.humanizeRangeUs : quarterStepUs;
+    if (table.groove && table.groove->length > 0)
+        renderLeadUs += table.groove->leadUs;
+
+    // Stopped, or waiting for the dispatcher to finish silencing
+    if (transportStopped || flushRequested)
+        return;
+
+    bool mastering = clockMaster && !clockSource;
+    if (!mastering || table.size == 0)
+        stopClock(now);
+
+    if (table.size > 0)
+    {
+        uint32_t periodUs = periodWholeUs(tempoStepPeriodQ32());
+        if (clockSource && clockSource->locked())
+        {
+            // A fresh lock or a relocation counts the grid from tick 0 at the current ratio
+            if (!tickLocked || relocatePending)
+            {
+                appliedRatio = clockRatio;
+                tickOrigin = 0;
+                ratioSwitchPending = false;
+            }
+            // Re-align on lock, a new step count or meter, a relocation or after falling
+            // behind; otherwise re-read the next step's time from the latest tick estimate
+            if (!tickLocked || tickDivision != &followTickDivision() || !gridRunning || relocatePending)
+                lockToTicks(table);
+            else
+                nextStep.reset(tickPositionUs(nextStepTick));
+            if (now > nextStep.us + periodUs)
+                lockToTicks(table);
+            switchClockRatio();
+        }
+        else
+        {
+            // Losing the clock continues on the internal tempo from the last step
+            tickLocked = false;
+            // Resync after idle instead of bursting through missed steps
+            if (!gridRunning || now > nextStep.us + periodUs || relocatePending)
+            {
+                stopClock(now); // The grid jumps: restart downstream gear with it
+                nextStep.reset(now);
+                grooveIndex = 0;
+            }
+            if (relocatePending)
+            {
+                locateStep(table, tickPositionAtOrAfter(startTick, tickDivisionFor(stepsPerBar, barTicks, clockRatio)).step);
+                relocatePending = false;
+            }
+            if (alignPending)
+            {
+                stopClock(now); // The grid jumps: restart downstream gear with it
+                alignToDownbeat(table, now);
+            }
+        }
+        alignPending = false;
+        gridRunning = true;
+
+        for (size_t rendered = 0; rendered < maxLookaheadSteps && nextStep.us < horizonUs + renderLeadUs; ++rendered)
+        {
+            const ScheduledStep &step = table.steps[currentNoteIndex % table.size];
+            uint8_t hits = step.ratchet > 1 ? step.ratchet : 1;
+            // Room for every hit's note-ons plus any offs forced out by a full heap
+            if (queueSpace() < 2 * maxNotesPerStep * hits)
+                break;
+            if (mastering)
+                clockStep(nextStep.us);
+            int64_t fireUs = static_cast<int64_t>(nextStep.us) +
+                             humanizeOffset(table.humanize, table.humanizeRangeUs, periodUs);
+            if (table.groove && table.groove->length > 0)
+            {
+                if (grooveIndex >= table.groove->length)
+                    grooveIndex = 0;
+                fireUs += table.groove->offsetUs[grooveIndex++];
+            }
+
+            // Advance the grid first: ratchet hits split the step's actual span
+            uint64_t stepUs = nextStep.us;
+            if (tickLocked)
+            {
+                nextStepTick.advance(*tickDivision);
+                nextStep.reset(tickPositionUs(nextStepTick));
+                switchClockRatio();
+            }
+            else
+            {
+                nextStep.advance(tempoAdvanceStep());
+            }
+            uint64_t stepSpanUs = nextStep.us - stepUs;
+            uint32_t hitLengthUs = step.lengthUs / hits; // The gate applies to each subdivision
+
+            uint8_t velocities[maxNotesPerStep];
+            for (uint8_t i = 0; i < step.noteCount; ++i)
+                velocities[i] = step.velocities[i];
+            for (uint8_t hit = 0; hit < hits; ++hit)
+            {
+                int64_t hitUs = fireUs + static_cast<int64_t>(stepSpanUs * hit / hits);
+                uint64_t dueUs = hitUs > 0 ? static_cast<uint64_t>(hitUs) : 0;
+                uint64_t onUs = dueUs > now ? dueUs : now; // Rendered late: send now, counted late
+
+                // Offs may not eat the room checked above for this step's hits
+                flushNoteOffs(onUs, 2 * maxNotesPerStep * (hits - hit));
+                for (uint8_t i = 0; i < step.noteCount; ++i)
+                {
+                    PendingNoteOff off;
+                    // Heap full: release the earliest pending note early rather than lose one
+                    if (pendingOffs.full() && pendingOffs.popEarliest(off))
+                        pushEvent({onUs, onUs, EVENT_NOTE_OFF, 0, 0, off.voice});
+                    uint8_t voice = nextVoice++;
+                    // Only a queued note-on gets an off
+                    if (pushEvent({onUs, dueUs, EVENT_NOTE_ON, step.notes[i], velocities[i], voice}))
+                        pendingOffs.push(onUs + hitLengthUs, voice);
+                    if (step.ratchetDecayPercent > 0)
+                    {
+                        int decayed = velocities[i] * (100 - step.ratchetDecayPercent) / 100;
+                        velocities[i] = decayed > 0 ? decayed : 1;
+                    }
+                }
+            }
+            if (++noteRepeatCounter >= table.repeat)
+            {
+                noteRepeatCounter = 0;
+                currentNoteIndex = (currentNoteIndex + 1) % table.size;
+            }
+        }
+    }
+    else
+    {
+        gridRunning = false;
+    }
+    // Offs up to the earliest the next step can fire, so none lands after its note-on
+    uint64_t nextFireUs = nextStep.us > renderLeadUs ? nextStep.us - renderLeadUs : 0;
+    flushNoteOffs(gridRunning && nextFireUs < horizonUs ? nextFireUs : horizonUs);
+    if (segmentOpen)
+        renderClockTicks(horizonUs);
+}
+
+void stepSchedulerBegin(const StepOutput &output)
+{
+    stepOutput = output;
+#ifdef ARDUINO
+    esp_timer_create_args_t args = {};
+    args.callback = stepTimerCallback;
+    args.name = "arpStep";
+    esp_timer_create(&args, &stepTimer);
+#endif
+    armStepTimer(idlePollUs);
+}
+
+void stepSchedulerFollowClock(const ClockTracker *tracker)
+{
+    clockSource = tracker;
+}
+
+void stepSchedulerSendClock(bool enable)
+{
+    clockMaster = enable;
+}
+
+void stepSchedulerAlign(uint64_t downbeatUs)
+{
+    alignDownbeatUs = downbeatUs;
+    alignPending = true;
+}
+
+void stepSchedulerSetLatency(uint8_t destination, uint32_t latencyUs)
+{
+    if (destination < maxOutputDestinations)
+        outputLatencyUs[destination] = latencyUs < maxOutputLatencyUs ? latencyUs : maxOutputLatencyUs;
+}
+
+void stepSchedulerStop()
+{
+    transportStopped = true;
+    gridRunning = false;
+    pendingOffs.clear(); // The flush releases every sounding note
+    flushRequested = true;
+}
+
+void stepSchedulerStart(uint32_t tick)
+{
+    if (!transportStopped)
+        stepSchedulerStop(); // Restart: silence the old position first
+    transportStopped = false;
+    gridRunning = false;
+    startTick = tick;
+    relocatePending = true;
+}
+
+bool stepSchedulerStopped()
+{
+    return transportStopped;
+}
+
+ClockRatio stepSchedulerClockRatio()
+{
+    return appliedRatio;
+}
+
+StepTable &stepSchedulerBackTable()
+{
+    return stepTables[1 - activeTable];
+}
+
+void stepSchedulerPublish(bool remapPosition)
+{
+    size_t oldSize = stepTables[activeTable].size;
+    size_t newSize = stepTables[1 - activeTable].size;
+    if (remapPosition && oldSize > 0 && newSize > 0 && newSize != oldSize)
+        currentNoteIndex = (currentNoteIndex % oldSize) * newSize / oldSize;
+    activeTable = 1 - activeTable;
+    renderAhead();
+}
+
+SchedulerStats stepSchedulerStats()
+{
+    uint32_t depth = 0;
+    for (uint8_t d = 0; d < maxOutputDestinations; ++d)
+        if (eventQueues[d].depth() > depth)
+            depth = eventQueues[d].depth();
+    return {dispatchedCount, lateCount, depth, maxDepth};
+}
+
+void stepSchedulerRequestJitter()
+{
+    jitterSnapshotRequested.store(true, std::memory_order_relaxed);
+}
+
+bool stepSchedulerJitter(JitterHistogram &histogram)
+{
+    if (jitterSnapshotRequested.load(std::memory_order_acquire))
+        return false;
+    histogram = jitterSnapshot;
+    return true;
+}
+
+void stepSchedulerResetJitter()
+{
+    jitterResetRequested = true;
+}
+
+#ifndef ARDUINO
+void stepSchedulerSimulate(uint64_t untilUs)
+{
+    while (simArmed && simDeadlineUs <= untilUs)
+    {
+        timebaseSimSet(simDeadlineUs);
+        simArmed = false;
+        stepTimerCallback(nullptr);
+    }
+    timebaseSimSet(untilUs);
+}
+#endif
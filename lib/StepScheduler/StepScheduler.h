@@ -0,0 +1,138 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "Groove.h"
+#include "Humanize.h"
+#include "JitterHistogram.h"
+#include "ClockTracker.h"
+#include "Constants.h"
+
+// --- STEP SCHEDULER ---
+// loop() renders a step table and publishes it; the scheduler then renders the
+// next few steps into a look-ahead queue of timestamped note on/off events.
+// A one-shot hardware timer (esp_timer) only drains the events that are due,
+// so timing no longer depends on how busy loop() is, and random chords, bias
+// and humanize are all resolved well before their deadline. Timing humanize
+// is drawn in step order as steps are rendered, so drift stays correlated.
+// On a host build (no ARDUINO) a simulated timer stands in for esp_timer
+// (pio test -e native, see test/test_step_scheduler).
+
+const size_t maxScheduledSteps = 512;
+const size_t maxNotesPerStep = 3; // Random chord steps are 3-note chords
+const uint8_t maxRatchetHits = 8; // Ratchet: evenly spaced hits within one step
+
+const uint32_t lookaheadUs = 25000;  // Render events this far ahead of now
+const size_t maxLookaheadSteps = 4;  // ...but never more than this many steps
+const uint32_t lateEventUs = 1000;   // Dispatch later than this counts as late
+
+// Each output destination (DIN, USB) gets its own copy of the schedule, notes
+// and clock alike, sent early by that destination's latency so layered synths
+// sound together and a slaved device's clock stays in step with its notes
+const uint8_t maxOutputDestinations = 2;
+const uint32_t maxOutputLatencyUs = 20000; // Stays inside the look-ahead
+
+struct ScheduledStep
+{
+    uint8_t noteCount;
+    uint8_t notes[maxNotesPerStep];      // Before transpose/scale (mapped at emission)
+    uint8_t velocities[maxNotesPerStep]; // Final velocity per note
+    uint32_t lengthUs;                   // Gate length, already randomized (may exceed the step)
+    uint8_t ratchet;                     // Hits in the step, 1 = plain step, up to maxRatchetHits
+    uint8_t ratchetDecayPercent;         // Velocity drop from one hit to the next
+};
+
+struct StepTable
+{
+    ScheduledStep steps[maxScheduledSteps];
+    size_t size;
+    int repeat;                // Times each step is played before advancing
+    const GrooveTable *groove; // Resolved groove offsets by grid position (may be null)
+    HumanizeProfile humanize;  // Timing humanize, drawn as each step is rendered
+    uint32_t humanizeRangeUs;  // ...spread either side of the grid, 0 = off
+};
+
+// Output hooks, called from the timer context
+struct StepOutput
+{
+    // Returns true when the output buffers the note-on and reports through
+    // departed() when it actually left; false when it left during the call
+    bool (*noteOn)(uint8_t destination, uint8_t note, uint8_t velocity, uint64_t dueUs);
+    void (*noteOff)(uint8_t destination, uint8_t note);
+    uint8_t (*mapNote)(uint8_t note);   // Transpose/scale at emission time
+    void (*realtime)(uint8_t destination, uint8_t status); // Clock/Start/Stop, ahead of queued notes
+    bool (*serviceOutput)();            // Feed the UART; true while bytes are waiting
+    bool (*departed)(uint64_t &dueUs, uint64_t &departedUs); // Next buffered note-on that left (may be null)
+};
+
+// Dispatch counters
+struct SchedulerStats
+{
+    uint32_t dispatched; // Events sent, counted per destination
+    uint32_t late;       // Events sent more than lateEventUs after their intended time
+    uint32_t depth;      // Events currently queued (deepest destination)
+    uint32_t maxDepth;   // High-water mark of the queues
+};
+
+// Create the timer and start dispatching
+void stepSchedulerBegin(const StepOutput &output);
+
+// Back buffer for loop() to render into
+StepTable &stepSchedulerBackTable();
+
+// Follow an external clock: while the tracker is locked, steps land on exact
+// 24 PPQN tick positions (see TickGrid.h) instead of the internal tempo.
+// Null, or losing lock, continues on the internal tempo from the last step.
+// A Stop holds through losing the clock; only Start, Continue or Song Position
+// (or the caller changing sync mode) resumes.
+// clockRatio scales the bar against the ticks (half/double time, triplets); a
+// change takes effect on the next beat, where the step grid restarts in phase.
+void stepSchedulerFollowClock(const ClockTracker *tracker);
+
+// Clock ratio the step grid currently runs at: clockRatio once the pending
+// switch has reached its beat
+ClockRatio stepSchedulerClockRatio();
+
+// Clock master: send 24 PPQN clock interpolated between the rendered step
+// times, so clock and steps share one timebase (and follow tempo ramps).
+// Start goes out with the first step and Stop when the arp stops or the
+// master is switched off. Ignored while steps follow an external clock.
+void stepSchedulerSendClock(bool enable);
+
+// Tap tempo: move the internal grid so a bar starts at downbeatUs (in the
+// future). Steps before it keep playing on the new grid, with the pattern
+// positioned to reach its first step on the downbeat. Ignored while steps
+// follow an external clock.
+void stepSchedulerAlign(uint64_t downbeatUs);
+
+// Output latency of a destination: its events go out this much earlier
+// (clamped to maxOutputLatencyUs). Applies to events rendered from now on.
+void stepSchedulerSetLatency(uint8_t destination, uint32_t latencyUs);
+
+// Transport (MIDI Start/Continue/Stop). Stop silences what is sounding and
+// queued, and rendering pauses until start. Start runs from a song position in
+// ticks (0 = Start): the step and pattern position are computed directly from
+// the tick, so a mid-song Continue lands on the right step with no catch-up.
+void stepSchedulerStop();
+void stepSchedulerStart(uint32_t tick);
+bool stepSchedulerStopped();
+
+// Swap the back buffer in and render ahead into the event queue. With
+// remapPosition, a change in step count moves the position proportionally
+// instead of letting the modulo jump.
+void stepSchedulerPublish(bool remapPosition);
+
+SchedulerStats stepSchedulerStats();
+
+// Note-on emission jitter: the time a note-on actually left (after the write,
+// or for DIN when its status byte reached the UART) minus its grid time, so
+// late rendering and output queueing both count. Snapshot and reset are
+// carried out by the dispatcher, so neither races a recording: request a
+// snapshot, then stepSchedulerJitter() returns true once it has been taken.
+void stepSchedulerRequestJitter();
+bool stepSchedulerJitter(JitterHistogram &histogram);
+void stepSchedulerResetJitter();
+
+#ifndef ARDUINO
+// Host build: advance the simulated clock, firing the timer whenever it is due
+void stepSchedulerSimulate(uint64_t untilUs);
+#endif
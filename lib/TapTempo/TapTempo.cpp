@@ -0,0 +1,101 @@
+#include "TapTempo.h"
+
+// Median of a small array, sorted in place
+static float median(float *values, int n)
+{
+    for (int i = 1; i < n; ++i)
+    {
+        float v = values[i];
+        int j = i - 1;
+        for (; j >= 0 && values[j] > v; --j)
+            values[j + 1] = values[j];
+        values[j + 1] = v;
+    }
+    return (n % 2) ? values[n / 2] : 0.5f * (values[n / 2 - 1] + values[n / 2]);
+}
+
+bool TapTempo::tap(uint64_t tapUs)
+{
+    if (count > 0 && tapUs - times[count - 1] > maxTapGapUs)
+        count = 0;
+    if (count == maxTaps)
+    {
+        for (int i = 1; i < maxTaps; ++i)
+            times[i - 1] = times[i];
+        --count;
+    }
+    times[count++] = tapUs;
+    if (count < minTaps)
+        return false;
+    fit();
+    return valid();
+}
+
+void TapTempo::fit()
+{
+    // Times relative to the first tap keep float precision
+    float t[maxTaps];
+    for (int i = 0; i < count; ++i)
+        t[i] = static_cast<float>(times[i] - times[0]);
+
+    float scratch[maxTaps * (maxTaps - 1) / 2];
+    for (int i = 1; i < count; ++i)
+        scratch[i - 1] = t[i] - t[i - 1];
+    float beatUs = median(scratch, count - 1);
+    if (beatUs <= 0)
+        return;
+
+    // Number the taps in beats; a tap landing on the previous beat is a double tap
+    int beat[maxTaps];
+    bool used[maxTaps];
+    beat[0] = 0;
+    used[0] = true;
+    int lastUsed = 0;
+    for (int i = 1; i < count; ++i)
+    {
+        int beats = static_cast<int>((t[i] - t[lastUsed]) / beatUs + 0.5f);
+        used[i] = beats > 0;
+        beat[i] = beat[lastUsed] + beats;
+        if (used[i])
+            lastUsed = i;
+    }
+
+    // Theil-Sen fit, then once more without the taps far off the first line
+    float slope = beatUs;
+    float intercept = 0;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        int n = 0;
+        for (int i = 0; i < count; ++i)
+            for (int j = i + 1; j < count; ++j)
+                if (used[i] && used[j] && beat[j] != beat[i])
+                    scratch[n++] = (t[j] - t[i]) / (beat[j] - beat[i]);
+        if (n == 0)
+            return;
+        slope = median(scratch, n);
+
+        n = 0;
+        for (int i = 0; i < count; ++i)
+            if (used[i])
+                scratch[n++] = t[i] - slope * beat[i];
+        intercept = median(scratch, n);
+
+        for (int i = 0; i < count; ++i)
+        {
+            float residual = t[i] - (intercept + slope * beat[i]);
+            if (residual > outlierGate * slope || residual < -outlierGate * slope)
+                used[i] = false;
+        }
+    }
+
+    period = slope;
+    anchorUs = times[0] + static_cast<int64_t>(intercept + slope * beat[count - 1] + 0.5f);
+}
+
+uint64_t TapTempo::nextBeatUs(uint64_t afterUs) const
+{
+    if (period <= 0 || afterUs < anchorUs)
+        return anchorUs;
+    uint64_t beats = static_cast<uint64_t>((afterUs - anchorUs) / period) + 1;
+    return anchorUs + static_cast<uint64_t>(beats * period + 0.5f);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+
+// --- TAP TEMPO ---
+// Robust tempo from the last few taps. Each tap is numbered in beats from the
+// median tap interval, so a missed tap counts as two beats and a double tap
+// is dropped. A Theil-Sen line through (beat, time) then gives the period: the
+// median of the pairwise slopes, which a single late or early tap cannot pull.
+// Tempo is fractional and the fitted beat grid passes through the taps, so
+// the arp can start its bar in phase with them. No Arduino dependency.
+
+class TapTempo
+{
+public:
+    static const int maxTaps = 8;                 // Taps kept for the fit
+    static const int minTaps = 3;                 // Taps before the first estimate
+    static const uint32_t maxTapGapUs = 2000000;  // A longer pause (below 30 BPM) starts over
+    static constexpr float outlierGate = 0.25f;   // Drop taps further than this many beats off the fit
+
+    void reset() { count = 0; }
+
+    // Add a tap; true when a new estimate is ready
+    bool tap(uint64_t tapUs);
+
+    bool valid() const { return count >= minTaps && period > 0; }
+    float periodUs() const { return period; }
+    float bpm() const { return period > 0 ? 60000000.0f / period : 0; }
+
+    // First beat of the fitted grid after afterUs
+    uint64_t nextBeatUs(uint64_t afterUs) const;
+
+private:
+    uint64_t times[maxTaps];
+    int count = 0;
+    float period = 0;     // Fitted beat period, microseconds
+    uint64_t anchorUs = 0; // Fitted time of the last tap
+
+    void fit();
+};
@@ -0,0 +1,113 @@
+#include "Tempo.h"
+#include "Timebase.h"
+
+static uint32_t currentBpmQ16 = 0;
+static uint32_t targetBpmQ16 = 0;
+static uint32_t rampBeatsLeftQ16 = 0; // Beats left in the ramp, Q16.16
+static int tempoStepsPerBar = 0;
+static int tempoBarTicks = 0;
+static uint64_t periodQ32 = 0;       // Bar period / steps, rounded down
+static uint32_t periodRemainder = 0; // Bar period % steps, in 2^-32 us
+static uint32_t carry = 0;           // Remainder accumulated so far, < steps
+
+static uint32_t bpmToQ16(float bpm)
+{
+    return bpm > 0.0f ? static_cast<uint32_t>(bpm * 65536.0f + 0.5f) : 0;
+}
+
+static void retime()
+{
+    if (tempoStepsPerBar <= 0)
+    {
+        periodQ32 = 0;
+        periodRemainder = 0;
+        return;
+    }
+    uint64_t barQ32 = barPeriodFromTempoQ16(currentBpmQ16, tempoBarTicks);
+    periodQ32 = barQ32 / tempoStepsPerBar;
+    periodRemainder = static_cast<uint32_t>(barQ32 % tempoStepsPerBar);
+}
+
+void tempoSetTarget(float bpm, int stepsPerBar, int barTicks, int rampBeats)
+{
+    uint32_t bpmQ16 = bpmToQ16(bpm);
+    bool changed = false;
+
+    if (bpmQ16 != targetBpmQ16)
+    {
+        targetBpmQ16 = bpmQ16;
+        if (rampBeats > 0 && currentBpmQ16 > 0)
+        {
+            rampBeatsLeftQ16 = static_cast<uint32_t>(rampBeats) << 16;
+        }
+        else
+        {
+            currentBpmQ16 = bpmQ16;
+            rampBeatsLeftQ16 = 0;
+            changed = true;
+        }
+    }
+    if (stepsPerBar != tempoStepsPerBar || barTicks != tempoBarTicks)
+    {
+        // New meter: the bar split starts over from this step
+        tempoStepsPerBar = stepsPerBar;
+        tempoBarTicks = barTicks;
+        carry = 0;
+        changed = true;
+    }
+    if (changed)
+        retime();
+}
+
+void tempoJump(float bpm)
+{
+    targetBpmQ16 = currentBpmQ16 = bpmToQ16(bpm);
+    rampBeatsLeftQ16 = 0;
+    retime();
+}
+
+uint64_t tempoStepPeriodQ32()
+{
+    return periodQ32;
+}
+
+uint64_t tempoAdvanceStep()
+{
+    uint64_t period = periodQ32;
+    carry += periodRemainder;
+    if (tempoStepsPerBar > 0 && carry >= static_cast<uint32_t>(tempoStepsPerBar))
+    {
+        carry -= tempoStepsPerBar;
+        ++period; // One 2^-32 us unit of the remainder falls due on this step
+    }
+
+    if (rampBeatsLeftQ16 > 0 && tempoStepsPerBar > 0)
+    {
+        uint32_t stepBeatsQ16 = (static_cast<uint32_t>(tempoBarTicks) << 16) / (barTicksPerBeat * tempoStepsPerBar);
+        if (rampBeatsLeftQ16 <= stepBeatsQ16)
+        {
+            currentBpmQ16 = targetBpmQ16;
+            rampBeatsLeftQ16 = 0;
+        }
+        else
+        {
+            // Cover this step's share of the remaining distance: linear in beats,
+            // and still correct if steps per bar or the target change mid-ramp
+            int64_t remaining = static_cast<int64_t>(targetBpmQ16) - currentBpmQ16;
+            currentBpmQ16 += static_cast<int32_t>(remaining * stepBeatsQ16 / rampBeatsLeftQ16);
+            rampBeatsLeftQ16 -= stepBeatsQ16;
+        }
+        retime();
+    }
+    return period;
+}
+
+float tempoCurrentBpm()
+{
+    return currentBpmQ16 / 65536.0f;
+}
+
+bool tempoRamping()
+{
+    return rampBeatsLeftQ16 > 0;
+}
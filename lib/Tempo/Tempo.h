@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+
+// --- TEMPO ---
+// The one place step timing is derived. loop() hands over the target tempo,
+// steps per bar and bar length; the scheduler pulls one step period per
+// rendered step, which integrates any running ramp in Q16.16 BPM. Tempo
+// changes therefore land between steps and never leave a gap or a burst.
+// Steps are exact rationals of the bar: the bar period is split into
+// steps with the remainder carried Bresenham-style, so every run of
+// stepsPerBar steps adds up to exactly one bar (5/4 over 7 steps, 9 steps
+// over 4/4) and nothing accumulates from truncating the step period.
+
+const int maxTempoRampBeats = 32;
+
+// Set the target tempo (quarter notes per minute). With rampBeats > 0 a change
+// of target glides there linearly over that many beats; otherwise it applies
+// from the next step. A change of stepsPerBar or barTicks (bar length in 24
+// PPQN ticks, see Timebase.h) applies from the next step.
+void tempoSetTarget(float bpm, int stepsPerBar, int barTicks, int rampBeats);
+
+// Jump to a tempo immediately, cancelling any ramp (external clock)
+void tempoJump(float bpm);
+
+// Nominal period of the next step (bar / steps, rounded down), Q32.32 microseconds
+uint64_t tempoStepPeriodQ32();
+
+// Scheduler: period of the step being rendered, then integrate the ramp by one step
+uint64_t tempoAdvanceStep();
+
+// Tempo the grid is currently running at
+float tempoCurrentBpm();
+bool tempoRamping();
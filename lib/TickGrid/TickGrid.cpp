@@ -0,0 +1,64 @@
+#include "TickGrid.h"
+
+struct TickDivisionTable
+{
+    TickDivision entries[CLOCK_RATIO_COUNT][timeSignatureOptionsSize][stepsPerBarOptionsSize];
+};
+
+static constexpr TickDivisionTable makeTickDivisionTable()
+{
+    TickDivisionTable table{};
+    for (int r = 0; r < CLOCK_RATIO_COUNT; ++r)
+    {
+        for (int t = 0; t < timeSignatureOptionsSize; ++t)
+        {
+            int barTicks = barTicksFor(timeSignatureOptions[t]) * clockRatioScales[r].numerator / clockRatioScales[r].denominator;
+            for (int i = 0; i < stepsPerBarOptionsSize; ++i)
+            {
+                int steps = stepsPerBarOptions[i];
+                table.entries[r][t][i] = {static_cast<uint16_t>(barTicks / steps),
+                                          static_cast<uint16_t>(barTicks % steps),
+                                          static_cast<uint16_t>(steps),
+                                          static_cast<uint16_t>(barTicks)};
+            }
+        }
+    }
+    return table;
+}
+
+// Every time signature's bar must divide evenly under every ratio
+static constexpr bool ratiosDivideBars()
+{
+    for (int r = 0; r < CLOCK_RATIO_COUNT; ++r)
+        for (int t = 0; t < timeSignatureOptionsSize; ++t)
+            if (barTicksFor(timeSignatureOptions[t]) * clockRatioScales[r].numerator % clockRatioScales[r].denominator != 0)
+                return false;
+    return true;
+}
+
+static_assert(ratiosDivideBars(), "Clock ratios must give whole-tick bars");
+
+static constexpr TickDivisionTable tickDivisions = makeTickDivisionTable();
+
+const TickDivision &tickDivisionFor(int stepsPerBar, int barTicks, ClockRatio ratio)
+{
+    const TickDivision(&normal)[timeSignatureOptionsSize][stepsPerBarOptionsSize] = tickDivisions.entries[CLOCK_RATIO_NORMAL];
+    for (int t = 0; t < timeSignatureOptionsSize; ++t)
+    {
+        if (normal[t][0].barTicks != barTicks)
+            continue;
+        for (int i = 0; i < stepsPerBarOptionsSize; ++i)
+            if (normal[t][i].steps == stepsPerBar)
+                return tickDivisions.entries[ratio][t][i];
+    }
+    return tickDivisions.entries[ratio][0][0];
+}
+
+TickPosition tickPositionAtOrAfter(uint32_t tick, const TickDivision &division)
+{
+    // step = ceil(tick / ticksPerStep), ticksPerStep = barTicks / steps
+    uint64_t scaled = static_cast<uint64_t>(tick) * division.steps;
+    uint32_t step = static_cast<uint32_t>((scaled + division.barTicks - 1) / division.barTicks);
+    uint64_t stepTicks = static_cast<uint64_t>(step) * division.barTicks;
+    return {step, static_cast<uint32_t>(stepTicks / division.steps), static_cast<uint32_t>(stepTicks % division.steps)};
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "Constants.h"
+#include "ClockTracker.h"
+#include "Timebase.h"
+
+// --- TICK GRID ---
+// Step positions under external clock, counted in 24 PPQN ticks from the
+// downbeat. A step lasts barTicks / stepsPerBar ticks: whole ticks plus a
+// remainder in 1/stepsPerBar of a tick, so 5, 7 or 9 steps per bar, in any
+// time signature, accumulate exactly and the arp never drifts against the master.
+
+static_assert(barTicksPerBeat == clockTicksPerBeat, "Bar lengths are counted in MIDI clock ticks");
+
+// Clock divide/multiply: the bar spans numerator / denominator of its ticks
+struct ClockRatioScale
+{
+    uint8_t numerator;
+    uint8_t denominator;
+};
+
+constexpr ClockRatioScale clockRatioScales[CLOCK_RATIO_COUNT] = {{2, 1}, {1, 1}, {2, 3}, {1, 2}};
+
+// Tempo the steps run at when the clock runs at clockBpm
+inline float clockRatioBpm(float clockBpm, ClockRatio ratio)
+{
+    return clockBpm * clockRatioScales[ratio].denominator / clockRatioScales[ratio].numerator;
+}
+
+// Ticks per step = whole + remainder / steps
+struct TickDivision
+{
+    uint16_t whole;
+    uint16_t remainder;
+    uint16_t steps;
+    uint16_t barTicks; // After the clock ratio
+};
+
+// Precomputed division for a stepsPerBarOptions value, a time signature's bar
+// length and a clock ratio
+const TickDivision &tickDivisionFor(int stepsPerBar, int barTicks, ClockRatio ratio = CLOCK_RATIO_NORMAL);
+
+struct TickPosition
+{
+    uint32_t step;      // Steps since the downbeat tick 0
+    uint32_t tick;      // Whole tick the step lands on or after
+    uint32_t remainder; // ...plus remainder / steps of a tick
+
+    void advance(const TickDivision &division)
+    {
+        ++step;
+        tick += division.whole;
+        remainder += division.remainder;
+        if (remainder >= division.steps)
+        {
+            remainder -= division.steps;
+            ++tick;
+        }
+    }
+};
+
+// First step boundary at or after a tick
+TickPosition tickPositionAtOrAfter(uint32_t tick, const TickDivision &division);
@@ -0,0 +1,36 @@
+#include "Timebase.h"
+
+#ifdef ARDUINO
+#include <esp_timer.h>
+#else
+static uint64_t simNowUs = 0;
+#endif
+
+uint64_t timebaseNowUs()
+{
+#ifdef ARDUINO
+    return static_cast<uint64_t>(esp_timer_get_time());
+#else
+    return simNowUs;
+#endif
+}
+
+#ifndef ARDUINO
+void timebaseSimSet(uint64_t nowUs)
+{
+    simNowUs = nowUs;
+}
+#endif
+
+uint64_t barPeriodFromTempoQ16(uint32_t bpmQ16, int barTicks)
+{
+    if (bpmQ16 == 0 || barTicks <= 0)
+        return 0;
+    // period = 60e6 * barTicks / (24 * bpm); long division keeps the
+    // 2^-32 us fraction without 128-bit arithmetic (divisor stays below 2^32)
+    const uint64_t numerator = (60000000ULL / barTicksPerBeat) * barTicks << 16;
+    const uint64_t divisor = bpmQ16;
+    uint64_t whole = numerator / divisor;
+    uint64_t frac = ((numerator % divisor) << 32) / divisor;
+    return (whole << 32) | frac;
+}
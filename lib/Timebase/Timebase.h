@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+
+// --- TIMEBASE ---
+// Single monotonic 64-bit microsecond clock for all sequencer timing (no
+// millis() wrap), plus a fixed-point phase accumulator for step times.
+// Periods are Q32.32 microseconds, so fractional tempos and odd step counts
+// accumulate no rounding error over long sets.
+
+// Monotonic microseconds since boot (esp_timer on target, simulated on host)
+uint64_t timebaseNowUs();
+
+#ifndef ARDUINO
+// Host build: set the simulated clock
+void timebaseSimSet(uint64_t nowUs);
+#endif
+
+// Bar lengths are counted in MIDI clock ticks (24 per quarter note), so a
+// time signature n/d lasts n * 96 / d ticks: 4/4 = 96, 7/8 = 84
+const int barTicksPerBeat = 24;
+
+// Bar period for a Q16.16 tempo (quarter notes) and bar length in ticks, Q32.32 microseconds
+uint64_t barPeriodFromTempoQ16(uint32_t bpmQ16, int barTicks);
+
+// Integer microseconds of a Q32.32 period
+inline uint32_t periodWholeUs(uint64_t periodQ32) { return static_cast<uint32_t>(periodQ32 >> 32); }
+
+// Absolute time with a 32-bit sub-microsecond fraction
+struct PhaseAccumulator
+{
+    uint64_t us = 0;   // Whole microseconds
+    uint32_t frac = 0; // Fraction of a microsecond, 2^-32 units
+
+    void reset(uint64_t nowUs)
+    {
+        us = nowUs;
+        frac = 0;
+    }
+
+    void advance(uint64_t periodQ32)
+    {
+        uint32_t periodFrac = static_cast<uint32_t>(periodQ32);
+        uint32_t sum = frac + periodFrac;
+        us += (periodQ32 >> 32) + (sum < frac ? 1 : 0); // Carry from the fraction
+        frac = sum;
+    }
+};
@@ -0,0 +1,101 @@
+#include "Voicing.h"
+#include <stdlib.h>
+
+void buildVoicingTable(VoicingTable &table, const std::vector<uint8_t> &sortedPlayed)
+{
+    // Collect pitch classes present in the played chord, ascending
+    bool present[12] = {false};
+    for (uint8_t n : sortedPlayed)
+        present[n % 12] = true;
+    int pcs[12];
+    int pcCount = 0;
+    for (int pc = 0; pc < 12; ++pc)
+    {
+        if (present[pc])
+            pcs[pcCount++] = pc;
+    }
+
+    for (int pc = 0; pc < 12; ++pc)
+        table.valid[pc] = false;
+
+    for (int i = 0; i < pcCount; ++i)
+    {
+        int pc = pcs[i];
+        int inversions[voicingInversions][3];
+        if (pcCount >= 3)
+        {
+            // Triad shape: root plus the next two chord pitch classes above it
+            int a = (pcs[(i + 1) % pcCount] - pc + 12) % 12;
+            int b = (pcs[(i + 2) % pcCount] - pc + 12) % 12;
+            while (b <= a)
+                b += 12;
+            const int triad[voicingInversions][3] = {
+                {0, a, b},       // Root position
+                {a, b, 12},      // First inversion
+                {b, 12, 12 + a}  // Second inversion
+            };
+            for (int inv = 0; inv < voicingInversions; ++inv)
+                for (int v = 0; v < 3; ++v)
+                    inversions[inv][v] = triad[inv][v];
+        }
+        else
+        {
+            // One or two pitch classes: stack them upward, doubling octaves,
+            // and take three consecutive tones from each rung
+            for (int inv = 0; inv < voicingInversions; ++inv)
+            {
+                for (int v = 0; v < 3; ++v)
+                {
+                    int k = i + inv + v;
+                    inversions[inv][v] = pcs[k % pcCount] - pc + 12 * (k / pcCount);
+                }
+            }
+        }
+
+        int c = 0;
+        for (int inv = 0; inv < voicingInversions; ++inv)
+        {
+            for (int oct = -1; oct <= 1; ++oct, ++c)
+            {
+                for (int v = 0; v < 3; ++v)
+                    table.offsets[pc][c][v] = inversions[inv][v] + 12 * oct;
+            }
+        }
+        table.valid[pc] = true;
+    }
+}
+
+bool chooseVoicing(const VoicingTable &table, uint8_t root, const uint8_t previous[3], uint8_t out[3])
+{
+    int pc = root % 12;
+    if (!table.valid[pc])
+        return false;
+
+    int bestScore = -1;
+    int best = 0;
+    for (int c = 0; c < voicingCandidates; ++c)
+    {
+        const int8_t *off = table.offsets[pc][c];
+        int score = 0;
+        bool inRange = true;
+        for (int v = 0; v < 3; ++v)
+        {
+            int note = root + off[v];
+            inRange = inRange && note >= 0 && note <= 127;
+            score += abs(note - previous[v]);
+        }
+        if (!inRange)
+            continue;
+        if (bestScore < 0 || score < bestScore)
+        {
+            bestScore = score;
+            best = c;
+        }
+    }
+    if (bestScore < 0)
+        return false;
+
+    for (int v = 0; v < 3; ++v)
+        out[v] = root + table.offsets[pc][best][v];
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// --- VOICE LEADING ---
+// Triad voicings for every root pitch class, precomputed when the played chord
+// changes. Choosing a voicing per step is then a scan over a few table entries
+// (no sorting, no allocation).
+const int voicingInversions = 3;
+const int voicingOctaves = 3; // One octave below, in place, one octave above
+const int voicingCandidates = voicingInversions * voicingOctaves;
+
+struct VoicingTable
+{
+    int8_t offsets[12][voicingCandidates][3]; // Semitone offsets from the step root, ascending
+    bool valid[12];                           // Root pitch class present in the played chord
+};
+
+// Build the candidate table from the sorted, deduplicated played chord
+void buildVoicingTable(VoicingTable &table, const std::vector<uint8_t> &sortedPlayed);
+
+// Pick the voicing of root closest to previous (3 ascending notes), scored by
+// total semitone movement. Returns false if root has no candidates.
+bool chooseVoicing(const VoicingTable &table, uint8_t root, const uint8_t previous[3], uint8_t out[3]);
@@ -1,18 +1,99 @@
 #include "MidiUtils.h"
 #include "Constants.h"
 #include <USBMIDI.h>
+#include "Timebase.h"
+#include "Tempo.h"
+#include "StepScheduler.h"
+#include "TickGrid.h"
+#include "MidiOut.h"
 
-volatile unsigned long clockTime = 0;
-volatile int clockCount = 0;
-float clockBpm = 120.0;
-volatile bool countTicks = false;
+ClockTracker clockTrackers[CLOCK_SOURCE_COUNT];
+ClockSource activeClockSource = CLOCK_SOURCE_NONE;
+static uint32_t songPositionTicks = 0; // Where Continue resumes (set by SPP)
 
 MidiState midiState = WaitingStatus;
 uint8_t midiStatus, midiData1;
 
+static uint8_t sysexBuffer[maxSysexLength];
+static size_t sysexLength = 0;
+static bool sysexActive = false;
+static bool sysexOverflow = false;
+
+// --- Held-notes key state ---
+// One entry per MIDI note, so every note and pedal event is O(1). The chord
+// itself is rebuilt from the table at most once per loop pass (rebuildHeldChord).
+uint8_t keyState[128] = {0};
+bool sustainPedal = false;
+bool heldChordDirty = false;
+
+static uint32_t keyOrder[128] = {0};      // Arrival stamp, keeps as-played order
+static uint32_t keySustainGen[128] = {0}; // Pedal generation a key was sustained in
+static uint32_t keyOrderCounter = 0;
+static uint32_t sustainGen = 0; // Bumped on pedal up: releases all sustained keys at once
+
+static inline bool keyActive(uint8_t note)
+{
+  return (keyState[note] & KEY_HELD) ||
+         ((keyState[note] & KEY_SUSTAINED) && keySustainGen[note] == sustainGen);
+}
+
+// Handle sustain pedal (CC64)
+void handleSustainPedal(bool down)
+{
+  if (down == sustainPedal)
+    return;
+  sustainPedal = down;
+  if (!down)
+  {
+    ++sustainGen;
+    heldChordDirty = true;
+  }
+}
+
+// Rebuild currentChord from the key-state table (HELD mode)
+void rebuildHeldChord()
+{
+  heldChordDirty = false;
+  capturingChord = false; // A capture in progress is superseded by the key table
+  bool wasEmpty = currentChord.empty();
+  currentChord.clear();
+  for (uint8_t n = 0; n < 128; ++n)
+  {
+    if (keyActive(n))
+      currentChord.push_back(n);
+  }
+  std::sort(currentChord.begin(), currentChord.end(),
+            [](uint8_t a, uint8_t b) { return keyOrder[a] < keyOrder[b]; });
+  // Start from the first step when the chord comes back from silence
+  if (wasEmpty)
+  {
+    currentNoteIndex = 0;
+    noteRepeatCounter = 0;
+  }
+}
+
 // Handle incoming MIDI note on
 void handleNoteOn(uint8_t note)
 {
+  note &= 0x7F;
+  // Track key state in every mode, so switching to HELD picks up keys already down
+  if (!keyActive(note))
+    keyOrder[note] = ++keyOrderCounter;
+  keyState[note] = KEY_HELD;
+  heldChordDirty = true;
+  if (chordInputMode == HELD)
+    return;
+
+  // Latch-add: once a chord is latched, toggle notes in/out of it in place
+  if (chordInputMode == LATCH_ADD && !capturingChord && !currentChord.empty())
+  {
+    auto it = std::find(currentChord.begin(), currentChord.end(), note);
+    if (it != currentChord.end())
+      currentChord.erase(it);
+    else
+      currentChord.push_back(note);
+    return;
+  }
   // Start capturing a new chord if not already capturing
   if (!capturingChord)
   {
@@ -30,6 +111,16 @@ void handleNoteOn(uint8_t note)
 // Handle incoming MIDI note off
 void handleNoteOff(uint8_t note)
 {
+  note &= 0x7F;
+  if (keyState[note] & KEY_HELD)
+  {
+    keyState[note] = sustainPedal ? KEY_SUSTAINED : 0;
+    keySustainGen[note] = sustainGen;
+    heldChordDirty = true;
+  }
+  if (chordInputMode == HELD)
+    return;
+
   // Latch chord when lead note is released
   if (capturingChord && note == leadNote)
   {
@@ -40,16 +131,87 @@ void handleNoteOff(uint8_t note)
   }
 }
 
+// --- Live transposition ---
+// Notes on the transpose channel, or below the split note, shift the running
+// sequence instead of recapturing it. The offset is applied at emission time.
+static bool isTransposeNote(uint8_t channel, uint8_t note)
+{
+  return (transposeChannel != 0 && channel == transposeChannel) ||
+         (transposeSplitNote != 0 && note < transposeSplitNote);
+}
+
+// Route a note on (channel 1-16) to transposition or chord input
+void dispatchNoteOn(uint8_t channel, uint8_t note)
+{
+  if (isTransposeNote(channel, note))
+  {
+    liveTranspose = static_cast<int>(note) - transposeReferenceNote;
+    return;
+  }
+  handleNoteOn(note);
+}
+
+// Route a note off (channel 1-16); transposition holds until the next transpose note
+void dispatchNoteOff(uint8_t channel, uint8_t note)
+{
+  if (isTransposeNote(channel, note))
+    return;
+  handleNoteOff(note);
+}
+
+// Collect SysEx bytes from either input; F7 (or any other status) ends the message
+static void sysexByte(uint8_t byte)
+{
+  if (byte == 0xF0)
+  {
+    sysexActive = true;
+    sysexOverflow = false;
+    sysexLength = 0;
+    return;
+  }
+  if (!sysexActive)
+    return;
+  if (byte & 0x80)
+  {
+    sysexActive = false;
+    if (byte == 0xF7 && !sysexOverflow)
+      handleSysEx(sysexBuffer, sysexLength);
+    return;
+  }
+  if (sysexLength < maxSysexLength)
+    sysexBuffer[sysexLength++] = byte;
+  else
+    sysexOverflow = true;
+}
+
 // Parse incoming MIDI bytes (hardware MIDI in)
 void readMidiByte(uint8_t byte)
 {
   if (byte == 0xF8)
   { // MIDI Clock
-    handleMidiClock();
+    handleMidiClock(CLOCK_SOURCE_DIN, timebaseNowUs());
+    return;
+  }
+  if (byte == 0xFA || byte == 0xFB || byte == 0xFC)
+  {
+    if (byte == 0xFA)
+      handleMidiStart(CLOCK_SOURCE_DIN);
+    else if (byte == 0xFB)
+      handleMidiContinue(CLOCK_SOURCE_DIN);
+    else
+      handleMidiStop(CLOCK_SOURCE_DIN);
+    return;
+  }
+  if (byte > 0xF8)
+    return; // Other realtime bytes may interleave anything, including SysEx
+  if (byte == 0xF0 || byte == 0xF7 || (sysexActive && !(byte & 0x80)))
+  {
+    sysexByte(byte);
     return;
   }
   if (byte & 0x80)
   {
+    sysexActive = false;
     midiStatus = byte;
     midiState = WaitingData1;
   }
@@ -63,51 +225,153 @@ void readMidiByte(uint8_t byte)
       break;
     case WaitingData2:
       if ((midiStatus & 0xF0) == 0x90 && byte > 0)
-        handleNoteOn(midiData1);
+        dispatchNoteOn((midiStatus & 0x0F) + 1, midiData1);
       else if ((midiStatus & 0xF0) == 0x80 || ((midiStatus & 0xF0) == 0x90 && byte == 0))
-        handleNoteOff(midiData1);
+        dispatchNoteOff((midiStatus & 0x0F) + 1, midiData1);
       else if ((midiStatus & 0xF0) == 0xB0) // CC
         handleMidiCC(midiData1, byte);
+      else if (midiStatus == 0xF2) // Song Position Pointer (no running status)
+      {
+        handleSongPosition(CLOCK_SOURCE_DIN, midiData1 | (byte << 7));
+        midiState = WaitingStatus;
+        break;
+      }
       midiState = WaitingData1;
       break;
     }
   }
 }
 
-void handleMidiClock()
+// --- Clock sources ---
+// Each input has its own tracker, so clock arriving on both never double counts.
+// One source is active at a time; tempo, the beat LED and transport follow it.
+
+static bool clockSourceAllowed(ClockSource source)
 {
-  // Only update clockTime and LED on first tick of cycle
-  if (!countTicks)
-  {
-    clockTime = millis();
-    countTicks = true;
-    neopixelWrite(ledBuiltIn, 0, 64, 0); // Red blink
-  }
+  return clockSourceSelect == CLOCK_SELECT_AUTO ||
+         (clockSourceSelect == CLOCK_SELECT_DIN && source == CLOCK_SOURCE_DIN) ||
+         (clockSourceSelect == CLOCK_SELECT_USB && source == CLOCK_SOURCE_USB);
+}
 
-  // Turn off LED after 6 ticks
-  if (clockCount == 6)
-    neopixelWrite(ledBuiltIn, 0, 0, 0);
+static bool clockSourceRunning(ClockSource source, uint64_t nowUs)
+{
+  return clockTrackers[source].locked() && !clockTrackers[source].timedOut(nowUs);
+}
+
+// Number the new source's ticks where the old source's grid puts them, so the
+// scheduler keeps its tick position across a failover
+static void alignTickNumbering(ClockTracker &to, const ClockTracker &from)
+{
+  if (from.tickCount() == 0 || from.periodUs() <= 0)
+    return;
+  float ticksApart = static_cast<float>(static_cast<int64_t>(to.lastTickUs() - from.lastTickUs())) / from.periodUs();
+  int32_t delta = static_cast<int32_t>(ticksApart + (ticksApart >= 0 ? 0.5f : -0.5f));
+  to.relocate(from.tickCount() + delta); // The next tick after the aligned last one
+}
+
+static void selectClockSource(uint64_t nowUs)
+{
+  if (activeClockSource != CLOCK_SOURCE_NONE && clockSourceAllowed(activeClockSource) &&
+      clockSourceRunning(activeClockSource, nowUs))
+    return;
 
-  // Every 24 ticks (one quarter note), update BPM and reset
-  if (clockCount >= 24)
+  ClockSource previous = activeClockSource;
+  activeClockSource = CLOCK_SOURCE_NONE;
+  for (int i = 0; i < CLOCK_SOURCE_COUNT; ++i)
   {
-    countTicks = false;
-    unsigned long interval = millis() - clockTime;
-    if (interval > 0)
+    ClockSource source = static_cast<ClockSource>(i);
+    if (source != previous && clockSourceAllowed(source) && clockSourceRunning(source, nowUs))
     {
-      float newBpm = 60000.0f / interval;
-      bpm = constrain((int)newBpm, 40, 240);
-      // Use stepsPerBar instead of notesPerBeat for arpInterval calculation
-      arpInterval = 60000 / (bpm * stepsPerBar);
+      if (previous != CLOCK_SOURCE_NONE)
+        alignTickNumbering(clockTrackers[source], clockTrackers[previous]);
+      activeClockSource = source;
+      break;
     }
-    clockCount = 0;
   }
-  else
+}
+
+const ClockTracker *activeClockTracker(uint64_t nowUs)
+{
+  selectClockSource(nowUs);
+  return activeClockSource == CLOCK_SOURCE_NONE ? nullptr : &clockTrackers[activeClockSource];
+}
+
+// Transport is taken from the active source, or from any allowed source while none is active
+static bool acceptTransport(ClockSource source)
+{
+  if (syncMode != SYNC_FOLLOW)
+    return false;
+  return activeClockSource == CLOCK_SOURCE_NONE ? clockSourceAllowed(source) : source == activeClockSource;
+}
+
+void handleMidiClock(ClockSource source, uint64_t tickUs)
+{
+  ClockTracker &tracker = clockTrackers[source];
+  // A long gap means the clock stopped: start timing over rather than average
+  // across it, but keep the tick numbering (Continue may have set it)
+  if (tracker.timedOut(tickUs))
+    tracker.reacquire();
+  tracker.tick(tickUs);
+
+  selectClockSource(tickUs);
+  if (source != activeClockSource)
+    return;
+
+  // Blink on each beat
+  uint32_t tickInBeat = (tracker.tickCount() - 1) % clockTicksPerBeat;
+  if (tickInBeat == 0)
+    neopixelWrite(ledBuiltIn, 0, 64, 0); // Red blink
+  else if (tickInBeat == 6)
+    neopixelWrite(ledBuiltIn, 0, 0, 0);
+
+  // Fractional tempo, refreshed every tick from the active source, at the
+  // ratio the steps actually run at (a new clockRatio waits for the beat)
+  if (syncMode == SYNC_FOLLOW)
   {
-    clockCount++;
+    bpm = constrain(clockRatioBpm(tracker.bpm(), stepSchedulerClockRatio()), 40.0f, 240.0f);
+    tempoJump(bpm); // Follow the clock without a ramp
   }
 }
 
+// Start: the next clock tick is the downbeat
+void handleMidiStart(ClockSource source)
+{
+  if (!acceptTransport(source))
+    return;
+  songPositionTicks = 0;
+  clockTrackers[source].relocate(0);
+  stepSchedulerStart(0);
+}
+
+// Continue: resume from the last Song Position Pointer
+void handleMidiContinue(ClockSource source)
+{
+  if (!acceptTransport(source))
+    return;
+  clockTrackers[source].relocate(songPositionTicks);
+  stepSchedulerStart(songPositionTicks);
+}
+
+void handleMidiStop(ClockSource source)
+{
+  if (!acceptTransport(source))
+    return;
+  stepSchedulerStop();
+}
+
+// SPP is normally sent while stopped and takes effect on Continue; while
+// running, relocate straight away
+void handleSongPosition(ClockSource source, uint16_t sixteenths)
+{
+  if (!acceptTransport(source))
+    return;
+  songPositionTicks = static_cast<uint32_t>(sixteenths) * ticksPerSongPositionUnit;
+  if (!stepSchedulerStopped())
+  {
+    clockTrackers[source].relocate(songPositionTicks);
+    stepSchedulerStart(songPositionTicks);
+  }
+}
 
 // Function to handle incoming USB MIDI packets
 void processUsbMidiPackets(USBMIDI &usbMIDI)
@@ -118,23 +382,48 @@ void processUsbMidiPackets(USBMIDI &usbMIDI)
     uint8_t cin = packet.header & 0x0F;
     if (packet.byte1 == 0xF8)
     {
-      handleMidiClock();
+      handleMidiClock(CLOCK_SOURCE_USB, timebaseNowUs());
+      continue;
+    }
+    if (cin == 0x0F || cin == 0x03) // Single-byte realtime, 3-byte system common
+    {
+      if (packet.byte1 == 0xFA)
+        handleMidiStart(CLOCK_SOURCE_USB);
+      else if (packet.byte1 == 0xFB)
+        handleMidiContinue(CLOCK_SOURCE_USB);
+      else if (packet.byte1 == 0xFC)
+        handleMidiStop(CLOCK_SOURCE_USB);
+      else if (packet.byte1 == 0xF2)
+        handleSongPosition(CLOCK_SOURCE_USB, packet.byte2 | (packet.byte3 << 7));
       continue;
     }
     switch (cin)
     {
     case 0x09: // Note On
       if (packet.byte3 > 0)
-        handleNoteOn(packet.byte2);
+        dispatchNoteOn((packet.byte1 & 0x0F) + 1, packet.byte2);
       else
-        handleNoteOff(packet.byte2);
+        dispatchNoteOff((packet.byte1 & 0x0F) + 1, packet.byte2);
       break;
     case 0x08: // Note Off
-      handleNoteOff(packet.byte2);
+      dispatchNoteOff((packet.byte1 & 0x0F) + 1, packet.byte2);
       break;
     case 0x0B: // Control Change (CC)
       handleMidiCC(packet.byte2, packet.byte3);
       break;
+    case 0x04: // SysEx start/continue (3 bytes)
+    case 0x07: // SysEx end (3 bytes)
+      sysexByte(packet.byte1);
+      sysexByte(packet.byte2);
+      sysexByte(packet.byte3);
+      break;
+    case 0x06: // SysEx end (2 bytes)
+      sysexByte(packet.byte1);
+      sysexByte(packet.byte2);
+      break;
+    case 0x05: // SysEx end (1 byte)
+      sysexByte(packet.byte1);
+      break;
     default:
       // No action for other CIN values
       break;
@@ -146,26 +435,94 @@ void processUsbMidiPackets(USBMIDI &usbMIDI)
 extern USBMIDI usbMIDI;
 extern HardwareSerial Serial2;
 
-// Send a single MIDI byte to hardware MIDI out
+// Queue a single MIDI byte for hardware MIDI out (realtime bytes go ahead of it)
 void midiSendByte(uint8_t byte)
 {
-  Serial2.write(byte);
+  midiOutWrite(byte);
 }
 
-// Send MIDI note on to both hardware and USB MIDI
-void sendNoteOn(uint8_t note, uint8_t velocity)
+// Send a realtime byte (clock, Start, Stop) to one destination, ahead of
+// queued notes on DIN
+void sendRealtime(uint8_t destination, uint8_t status)
 {
-  midiSendByte(0x90);
-  midiSendByte(note);
-  midiSendByte(velocity);
+  if (destination == OUTPUT_DIN)
+  {
+    midiOutRealtime(status);
+  }
+  else
+  {
+    midiEventPacket_t packet = {0x0F, status, 0, 0}; // CIN 0xF: single byte
+    usbMIDI.writePacket(&packet);
+  }
+}
+
+const char *outputDestinationNames[OUTPUT_DESTINATION_COUNT] = {"DIN", "USB"};
+
+// Send a complete SysEx message (F0 ... F7) to both hardware and USB MIDI
+void sendSysEx(const uint8_t *message, size_t length)
+{
+  sendSysExTo(OUTPUT_DIN, message, length);
+  sendSysExTo(OUTPUT_USB, message, length);
+}
+
+// Send a complete SysEx message (F0 ... F7) to one destination
+void sendSysExTo(uint8_t destination, const uint8_t *message, size_t length)
+{
+  if (destination == OUTPUT_DIN)
+  {
+    midiOutWriteMessage(message, length); // All or nothing
+    return;
+  }
+
+  // USB MIDI carries SysEx in 3-byte packets; the CIN of the last one says how many bytes it holds
+  size_t i = 0;
+  while (i < length)
+  {
+    size_t remaining = length - i;
+    midiEventPacket_t packet = {0, 0, 0, 0};
+    if (remaining > 3)
+    {
+      packet.header = 0x04;
+      packet.byte1 = message[i];
+      packet.byte2 = message[i + 1];
+      packet.byte3 = message[i + 2];
+      i += 3;
+    }
+    else
+    {
+      packet.header = static_cast<uint8_t>(0x04 + remaining); // 0x05, 0x06 or 0x07
+      packet.byte1 = message[i];
+      packet.byte2 = remaining > 1 ? message[i + 1] : 0;
+      packet.byte3 = remaining > 2 ? message[i + 2] : 0;
+      i = length;
+    }
+    usbMIDI.writePacket(&packet);
+  }
+}
+
+// Send MIDI note on to hardware or USB MIDI. On DIN the status byte is tagged
+// with dueUs, so midiOutDeparted() reports when it actually reached the UART;
+// returns true when that report will come.
+bool sendNoteOn(uint8_t destination, uint8_t note, uint8_t velocity, uint64_t dueUs)
+{
+  if (destination == OUTPUT_DIN)
+  {
+    const uint8_t message[] = {0x90, note, velocity};
+    return midiOutWriteMarked(message, sizeof(message), dueUs);
+  }
   usbMIDI.noteOn(note, velocity, 1); // Channel 1
+  return false;
 }
 
-// Send MIDI note off to both hardware and USB MIDI
-void sendNoteOff(uint8_t note)
+// Send MIDI note off to hardware or USB MIDI
+void sendNoteOff(uint8_t destination, uint8_t note)
 {
-  midiSendByte(0x80);
-  midiSendByte(note);
-  midiSendByte(0);
-  usbMIDI.noteOff(note, 0, 1); // Channel 1
+  if (destination == OUTPUT_DIN)
+  {
+    midiOutWriteRelease(0x80, note); // Never dropped
+  }
+  else
+  {
+    usbMIDI.noteOff(note, 0, 1); // Channel 1
+  }
 }
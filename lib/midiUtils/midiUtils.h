@@ -2,12 +2,22 @@
 
 #include <Arduino.h>
 #include <USBMIDI.h>
+#include "ClockTracker.h"
 
-// MIDI clock sync state
-extern volatile unsigned long clockTime;
-extern volatile int clockCount;
-extern float clockBpm;
-extern volatile bool countTicks;
+// MIDI clock sync state, one tracker per input
+enum ClockSource
+{
+    CLOCK_SOURCE_DIN,
+    CLOCK_SOURCE_USB,
+    CLOCK_SOURCE_COUNT,
+    CLOCK_SOURCE_NONE = CLOCK_SOURCE_COUNT
+};
+
+extern ClockTracker clockTrackers[CLOCK_SOURCE_COUNT];
+extern ClockSource activeClockSource;
+
+// Re-evaluate the active source (failing over if it stopped); null when none is running
+const ClockTracker *activeClockTracker(uint64_t nowUs);
 
 // --- MIDI parser state machine and variables ---
 enum MidiState
@@ -17,6 +27,14 @@ enum MidiState
     WaitingData2
 };
 
+// --- Held-notes key state (128-entry table, O(1) per event) ---
+const uint8_t KEY_HELD = 0x01;      // Key is physically down
+const uint8_t KEY_SUSTAINED = 0x02; // Key released while the sustain pedal was down
+
+extern uint8_t keyState[128];
+extern bool sustainPedal;
+extern bool heldChordDirty;
+
 extern MidiState midiState;
 extern uint8_t midiStatus;
 extern uint8_t midiData1;
@@ -27,12 +45,53 @@ void readMidiByte(uint8_t byte);
 // MIDI note handlers (must be visible to midiUtils)
 void handleNoteOn(uint8_t note);
 void handleNoteOff(uint8_t note);
+void dispatchNoteOn(uint8_t channel, uint8_t note);
+void dispatchNoteOff(uint8_t channel, uint8_t note);
 void handleMidiCC(uint8_t cc, uint8_t value);
 void processUsbMidiPackets(USBMIDI &usbMIDI);
 
-// MIDI clock sync handler
-void handleMidiClock();
+// Held-notes mode
+void handleSustainPedal(bool down);
+void rebuildHeldChord();
+
+// MIDI clock sync handler, tickUs = arrival time of the 0xF8 byte
+void handleMidiClock(ClockSource source, uint64_t tickUs);
+
+// Transport (only acted on when following MIDI clock)
+const uint32_t ticksPerSongPositionUnit = 6; // SPP counts 16th notes
+void handleMidiStart(ClockSource source);
+void handleMidiContinue(ClockSource source);
+void handleMidiStop(ClockSource source);
+void handleSongPosition(ClockSource source, uint16_t sixteenths);
+
+// --- SysEx ---
+// Messages are F0 7D <command> [data...] F7 (7D = non-commercial manufacturer ID)
+const uint8_t sysexManufacturerId = 0x7D;
+const uint8_t SYSEX_JITTER_DUMP = 0x01;  // Request: reply with SYSEX_JITTER_DATA
+const uint8_t SYSEX_JITTER_RESET = 0x02; // Request: clear the jitter histogram
+const uint8_t SYSEX_LATENCY_PING = 0x03; // F0 7D 03 <destination> F7, looped back to time an output
+const uint8_t SYSEX_JITTER_DATA = 0x11;  // Reply: histogram as 32-bit values, 5 septets each
+const size_t maxSysexLength = 32;        // Longer incoming messages are dropped
+
+// Incoming SysEx body (between F0 and F7), defined in main.cpp
+void handleSysEx(const uint8_t *data, size_t length);
+// Send a complete F0 ... F7 message to hardware and USB MIDI
+void sendSysEx(const uint8_t *message, size_t length);
+
+// --- Output destinations ---
+// Notes are scheduled per destination, each early by its own latency
+enum OutputDestination
+{
+    OUTPUT_DIN,
+    OUTPUT_USB,
+    OUTPUT_DESTINATION_COUNT
+};
+
+extern const char *outputDestinationNames[OUTPUT_DESTINATION_COUNT];
+
+void sendSysExTo(uint8_t destination, const uint8_t *message, size_t length);
 
 void midiSendByte(uint8_t byte);
-void sendNoteOn(uint8_t note, uint8_t velocity);
-void sendNoteOff(uint8_t note);
\ No newline at end of file
+void sendRealtime(uint8_t destination, uint8_t status);
+bool sendNoteOn(uint8_t destination, uint8_t note, uint8_t velocity, uint64_t dueUs);
+void sendNoteOff(uint8_t destination, uint8_t note);
\ No newline at end of file
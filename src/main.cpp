@@ -3,10 +3,22 @@
 #include <EEPROM.h>
 #include <USB.h>
 #include <USBMIDI.h>
+#include <esp_timer.h>
 #include "PatternGenerators.h"
 #include "Constants.h"
 #include "midiUtils.h"
 #include "ArpUtils.h"
+#include "Voicing.h"
+#include "ChordRecognition.h"
+#include "ScaleQuantizer.h"
+#include "StepScheduler.h"
+#include "Timebase.h"
+#include "Groove.h"
+#include "Humanize.h"
+#include "TapTempo.h"
+#include "Tempo.h"
+#include "Profiler.h"
+#include "MidiOut.h"
 
 // EEPROM_SIZE is not used, but left for reference
 #define EEPROM_SIZE 4096 // Make sure this is large enough for all patterns
@@ -44,11 +56,20 @@ const int encoderModeSize = MODE_COUNT; // Use enum count for size
 
 PatternPlaybackMode patternPlaybackMode = LOOP;
 
+ChordInputMode chordInputMode = LATCH;
+const char *chordInputModeNames[CHORD_INPUT_COUNT] = {"LATCH", "LATCH-ADD", "HELD"};
+SyncMode syncMode = SYNC_FOLLOW;
+const char *syncModeNames[SYNC_MODE_COUNT] = {"INTERNAL", "MIDI CLOCK", "MASTER"};
+ClockSourceSelect clockSourceSelect = CLOCK_SELECT_AUTO;
+const char *clockSourceSelectNames[CLOCK_SELECT_COUNT] = {"AUTO", "DIN", "USB"};
+ClockRatio clockRatio = CLOCK_RATIO_NORMAL;
+const char *clockRatioNames[CLOCK_RATIO_COUNT] = {"HALF TIME", "1:1", "TRIPLET", "DOUBLE TIME"};
+
 // --- PARAMETERS ---
 // (moved to Constants.h)
 
 // --- DEFAULTS ---
-int bpm = 96;                        // Beats per minute
+float bpm = 96;                      // Beats per minute (fractional when following clock)
 int noteLengthPercent = 40;          // Note length as percent of interval
 int noteVelocity = 127;              // MIDI velocity
 int octaveRange = 0;                 // Octave spread
@@ -56,15 +77,33 @@ int transpose = 0;                   // Transpose in octaves
 int velocityDynamicsPercent = 56;    // Velocity randomization percent
 bool timingHumanize = false;         // Enable timing humanization
 int timingHumanizePercent = 4;       // Humanization percent
+HumanizeProfile humanizeProfile = HUMANIZE_GAUSSIAN; // Shape of the timing humanize
 int noteLengthRandomizePercent = 20; // Note length randomization percent
 int noteBalancePercent = 0;          // Note bias percent
 int randomChordPercent = 0;          // Percentage of steps to replace with random 3-note chords
 int noteRangeShift = 0;              // Range shift for lowest/highest note, -24..24 (or -127..127 if you want)
 int noteRangeStretch = 0;            // Range stretch for lowest/highest note, -8..8
 int noteRepeat = 1;                  // Number of repeats per note
+int ratchetHits = 1;                 // Hits per ratcheted step, 1 = off, 2..8
+int ratchetPercent = 100;            // Chance that a step ratchets
+int ratchetDecayPercent = 0;         // Velocity drop from one ratchet hit to the next
 bool modeBar = false;                // MODE_BAR ON/OFF state
 bool patternReverse = false;         // REVERSE mode for pattern playback
 bool patternSmooth = true;           // SMOOTH mode for pattern playback
+bool voiceLeading = false;           // Voice random chords closest to the previous chord
+bool chordFill = false;              // Add missing tones of the recognised chord
+ScaleType scaleType = SCALE_CHROMATIC; // Output scale quantizer (chromatic = off)
+int scaleRoot = 0;                   // Scale root pitch class, 0 = C
+const uint8_t *scaleMap = scaleQuantizeTable(scaleType, scaleRoot); // Active note->note table
+uint8_t transposeChannel = 0;        // Channel whose notes transpose the sequence, 0 = off
+uint8_t transposeSplitNote = 0;      // Notes below this transpose the sequence, 0 = off
+int liveTranspose = 0;               // Live transposition in semitones
+GrooveType grooveType = GROOVE_STRAIGHT; // Swing/groove template
+int swingPercent = 58;               // Off-beat position within a pair for GROOVE_SWING, 50..75
+GrooveTable grooveTable;             // Groove resolved to microseconds for the current step period
+// Per-output latency: DIN spends three bytes on the wire per note, USB waits for a 1 ms frame
+uint32_t outputLatencyUs[OUTPUT_DESTINATION_COUNT] = {3 * midiOutByteUs, 0};
+static_assert(OUTPUT_DESTINATION_COUNT == maxOutputDestinations, "One schedule per MIDI output");
 
 // Debounce state for encoder switch
 static uint16_t encoderSWDebounce = 0; 
@@ -72,22 +111,82 @@ static uint16_t encoderSWDebounce = 0;
 // Steps per bar (for 4/4 bar), default index 7 = 8 steps
 int stepsPerBarIndex = 7;
 int stepsPerBar = stepsPerBarOptions[stepsPerBarIndex];
+int timeSignatureIndex = 2; // 4/4
+int barTicks = barTicksFor(timeSignatureOptions[timeSignatureIndex]);
+int polymeterSteps = 0; // Pattern length in steps, cycling against the bar (0 = off)
+int tempoRampBeats = 0; // Beats to glide to a new tempo, 0 = immediate
 
 int noteRepeatCounter = 0;
-unsigned long arpInterval = 60000 / (bpm * stepsPerBar); // ms per note
 
 // --- LED FLASH STATE ---
 unsigned long ledFlashStart = 0;            // When did LED flash start
 bool ledFlashing = false;                   // Is LED currently flashing
 const unsigned long ledFlashDuration = 100; // ms
 
+// --- TAP TEMPO ---
+// The ISRs timestamp the first falling edge of each press; loop() confirms the
+// press with its usual debounce and then takes the ISR time as the tap, so the
+// tap time carries no loop() latency and contact bounce never adds a tap.
+TapInput tapInput = TAP_CLEAR_BUTTON;
+const char *tapInputNames[TAP_INPUT_COUNT] = {"CLEAR BUTTON", "ENCODER SWITCH"};
+const uint32_t tapBounceUs = 20000;           // Edges closer than this belong to one press
+const unsigned long tapModeExitHoldMs = 800;  // Hold the tapping encoder switch this long to change mode
+TapTempo tapTempo;
+static volatile uint64_t tapEdgeFirstUs[TAP_INPUT_COUNT] = {}; // First edge of the latest press
+static volatile uint64_t tapEdgeLastUs[TAP_INPUT_COUNT] = {};
+
+static void IRAM_ATTR recordTapEdge(int input)
+{
+  uint64_t edgeUs = esp_timer_get_time();
+  if (edgeUs - tapEdgeLastUs[input] > tapBounceUs)
+    tapEdgeFirstUs[input] = edgeUs;
+  tapEdgeLastUs[input] = edgeUs;
+}
+
+static void IRAM_ATTR onClearButtonEdge() { recordTapEdge(TAP_CLEAR_BUTTON); }
+static void IRAM_ATTR onEncoderSwitchEdge() { recordTapEdge(TAP_ENCODER_SWITCH); }
+
+bool tapping(TapInput input)
+{
+  return encoderMode == MODE_TAP_TEMPO && tapInput == input;
+}
+
+// A debounced press on the tap input: set the tempo and start the next bar on the tap grid
+void handleTap(TapInput input)
+{
+  noInterrupts();
+  uint64_t tapUs = tapEdgeFirstUs[input];
+  interrupts();
+  uint64_t nowUs = timebaseNowUs();
+  if (nowUs - tapUs > tapBounceUs * 4)
+    tapUs = nowUs; // No edge seen: fall back to the debounced time
+
+  neopixelWrite(ledBuiltIn, 64, 0, 0); // Green LED flash
+  ledFlashStart = millis();
+  ledFlashing = true;
+
+  // A running external clock owns the tempo
+  if (syncMode == SYNC_FOLLOW && activeClockTracker(nowUs))
+    return;
+  if (tapTempo.tap(tapUs))
+  {
+    bpm = constrain(tapTempo.bpm(), 40.0f, 240.0f);
+    tempoJump(bpm);
+    stepSchedulerAlign(tapTempo.nextBeatUs(nowUs));
+  }
+}
+
 // --- Clear button handling ---
 void handleClearButton()
 {
   static bool lastClear = HIGH;
   bool currentClear = digitalRead(clearButtonPin);
+  if (lastClear == HIGH && currentClear == LOW && tapping(TAP_CLEAR_BUTTON))
+  {
+    handleTap(TAP_CLEAR_BUTTON);
+  }
   // If clear button pressed, clear chord and reset state
-  if (lastClear == HIGH && currentClear == LOW)
+  else if (lastClear == HIGH && currentClear == LOW)
   {
     currentChord.clear();
     currentNoteIndex = 0;
@@ -107,11 +206,16 @@ struct StepNotes
   std::vector<uint8_t> notes;
 };
 
+// Voice-leading candidates, rebuilt only when the played chord changes
+VoicingTable voicingTable;
+std::vector<uint8_t> voicingSource;
+
 void buildRandomChordSteps(
     std::vector<StepNotes> &stepNotes,
     const std::vector<uint8_t> &playingChord,
     const std::vector<uint8_t> &playedChord,
-    int percent)
+    int percent,
+    bool voiceLead)
 {
   stepNotes.clear();
   if (playingChord.empty() || playedChord.size() < 3 || percent <= 0)
@@ -146,12 +250,28 @@ void buildRandomChordSteps(
   for (int i = 0; i < numChords && i < (int)steps; ++i)
     isChordStep[indices[i]] = true;
 
+  // Voice leading: each chord step follows the previous one, starting from the played chord
+  if (voiceLead && sortedPlayed != voicingSource)
+  {
+    buildVoicingTable(voicingTable, sortedPlayed);
+    voicingSource = sortedPlayed;
+  }
+  size_t lastPlayed = sortedPlayed.size() - 1;
+  uint8_t previousVoicing[3] = {sortedPlayed[0], sortedPlayed[std::min<size_t>(1, lastPlayed)], sortedPlayed[std::min<size_t>(2, lastPlayed)]};
+
   for (size_t i = 0; i < steps; ++i)
   {
     if (isChordStep[i])
     {
       // The root note is the pattern note
       uint8_t root = playingChord[i];
+      uint8_t voiced[3];
+      if (voiceLead && chooseVoicing(voicingTable, root, previousVoicing, voiced))
+      {
+        stepNotes.push_back({std::vector<uint8_t>(voiced, voiced + 3)});
+        std::copy(voiced, voiced + 3, previousVoicing);
+        continue;
+      }
       // Find the next two higher notes from sortedPlayed, transposed up if needed
       std::vector<uint8_t> chord{root};
       // Find all notes in sortedPlayed that are higher than root
@@ -212,8 +332,6 @@ std::vector<uint8_t> tempChord;    // Chord being captured
 uint8_t leadNote = 0;              // First note of chord
 bool capturingChord = false;       // Are we capturing a chord?
 size_t currentNoteIndex = 0;       // Step in pattern
-bool noteOnActive = false;         // Is a note currently on?
-unsigned long noteOnStartTime = 0; // When was note on sent
 uint8_t lastPlayedNote = 0;        // Last note played
 
 
@@ -236,7 +354,7 @@ void handleMidiCC(uint8_t cc, uint8_t value)
     bpm = map(value, 0, 127, 40, 240);
     break;
   case 2: // Breath -> Note Length %
-    noteLengthPercent = map(value, 0, 127, 5, 100);
+    noteLengthPercent = map(value, 0, 127, 5, maxNoteLengthPercent);
     break;
   case 3: // CC3 -> Velocity
     noteVelocity = map(value, 0, 127, 1, 127);
@@ -259,6 +377,21 @@ void handleMidiCC(uint8_t cc, uint8_t value)
   case 9: // CC9 -> Note Repeat
     noteRepeat = constrain(map(value, 0, 127, 1, 4), 1, 4);
     break;
+  case 105: // CC105 -> Ratchet hits (1 = off)
+    ratchetHits = constrain(map(value, 0, 127, 1, maxRatchetHits), 1, maxRatchetHits);
+    break;
+  case 106: // CC106 -> Ratchet probability
+    ratchetPercent = map(value, 0, 127, 0, 100);
+    break;
+  case 107: // CC107 -> Ratchet velocity decay
+    ratchetDecayPercent = map(value, 0, 127, 0, 100);
+    break;
+  case 108: // CC108 -> Humanize Profile (uniform / gaussian / drift)
+    humanizeProfile = static_cast<HumanizeProfile>(constrain(map(value, 0, 127, 0, HUMANIZE_PROFILE_COUNT - 1), 0, HUMANIZE_PROFILE_COUNT - 1));
+    break;
+  case 109: // CC109 -> Clock Ratio (half / 1:1 / triplet / double)
+    clockRatio = static_cast<ClockRatio>(constrain(map(value, 0, 127, 0, CLOCK_RATIO_COUNT - 1), 0, CLOCK_RATIO_COUNT - 1));
+    break;
   case 10: // CC10 -> Transpose
     transpose = map(value, 0, 127, minTranspose, maxTranspose);
     break;
@@ -287,38 +420,315 @@ void handleMidiCC(uint8_t cc, uint8_t value)
   case 19: // CC19 -> Range Stretch
     noteRangeStretch = map(value, 0, 127, -24, 24);
     break;
-  case 20: // CC20 -> Steps (4/4 bar)
+  case 20: // CC20 -> Steps per bar
     stepsPerBarIndex = constrain(map(value, 0, 127, 0, stepsPerBarOptionsSize - 1), 0, stepsPerBarOptionsSize - 1);
     stepsPerBar = stepsPerBarOptions[stepsPerBarIndex];
     break;
+  case 21: // CC21 -> Chord Input Mode
+    chordInputMode = static_cast<ChordInputMode>(constrain(map(value, 0, 127, 0, CHORD_INPUT_COUNT - 1), 0, CHORD_INPUT_COUNT - 1));
+    heldChordDirty = true;
+    break;
+  case 22: // CC22 -> Voice Leading
+    voiceLeading = (value >= 64);
+    break;
+  case 23: // CC23 -> Chord Fill
+    chordFill = (value >= 64);
+    break;
+  case 24: // CC24 -> Scale
+    scaleType = static_cast<ScaleType>(constrain(map(value, 0, 127, 0, SCALE_COUNT - 1), 0, SCALE_COUNT - 1));
+    scaleMap = scaleQuantizeTable(scaleType, scaleRoot);
+    break;
+  case 25: // CC25 -> Scale Root
+    scaleRoot = constrain(map(value, 0, 127, 0, 11), 0, 11);
+    scaleMap = scaleQuantizeTable(scaleType, scaleRoot);
+    break;
+  case 26: // CC26 -> Transpose Channel (0 = off)
+    transposeChannel = constrain(map(value, 0, 127, 0, 16), 0, 16);
+    if (transposeChannel == 0 && transposeSplitNote == 0)
+      liveTranspose = 0;
+    break;
+  case 27: // CC27 -> Transpose Split Note (0 = off)
+    transposeSplitNote = value;
+    if (transposeChannel == 0 && transposeSplitNote == 0)
+      liveTranspose = 0;
+    break;
+  case 28: // CC28 -> Groove
+    grooveType = static_cast<GrooveType>(constrain(map(value, 0, 127, 0, GROOVE_COUNT - 1), 0, GROOVE_COUNT - 1));
+    break;
+  case 29: // CC29 -> Swing
+    swingPercent = map(value, 0, 127, minSwingPercent, maxSwingPercent);
+    break;
+  case 30: // CC30 -> Tempo Ramp (beats, 0 = immediate)
+    tempoRampBeats = map(value, 0, 127, 0, maxTempoRampBeats);
+    break;
+  case 31: // CC31 -> Sync (internal / MIDI clock / master)
+    syncMode = static_cast<SyncMode>(constrain(map(value, 0, 127, 0, SYNC_MODE_COUNT - 1), 0, SYNC_MODE_COUNT - 1));
+    break;
+  case 102: // CC102 -> Clock Source (auto / DIN / USB)
+    clockSourceSelect = static_cast<ClockSourceSelect>(constrain(map(value, 0, 127, 0, CLOCK_SELECT_COUNT - 1), 0, CLOCK_SELECT_COUNT - 1));
+    break;
+  case 103: // CC103 -> Time Signature
+    timeSignatureIndex = constrain(map(value, 0, 127, 0, timeSignatureOptionsSize - 1), 0, timeSignatureOptionsSize - 1);
+    barTicks = barTicksFor(timeSignatureOptions[timeSignatureIndex]);
+    break;
+  case 104: // CC104 -> Polymeter (pattern steps, 0 = off)
+    polymeterSteps = map(value, 0, 127, 0, maxPolymeterSteps);
+    break;
+  case 64: // CC64 -> Sustain pedal (HELD mode)
+    handleSustainPedal(value >= 64);
+    break;
   }
-  // Update arpInterval to reflect the note length for a 4/4 bar
-  unsigned long barLengthMs = 60000 / bpm * 4;
-  unsigned long noteLengthMs = barLengthMs / stepsPerBar;
-  arpInterval = noteLengthMs;
 }
 
-// --- TIMING HUMANIZATION FUNCTION ---
-// Returns a random offset for note timing (ms)
-int getTimingHumanizeOffset(unsigned long noteLengthMs)
+// --- OUTPUT NOTE MAPPING ---
+// Transpose, live transpose and scale quantize, applied by the scheduler at emission time
+uint8_t mapOutputNote(uint8_t note)
 {
-  int maxHumanize = noteLengthMs;
-  int timingHumanizeAmount = (maxHumanize * timingHumanizePercent) / 100;
-  if (timingHumanizeAmount == 0)
-    return 0;
-  return random(-timingHumanizeAmount, timingHumanizeAmount + 1);
+  return scaleMap[constrain(note + 12 * transpose + liveTranspose, 0, 127)];
+}
+
+// --- EMISSION JITTER REPORTING ---
+// The dispatcher copies the histogram on request; reports go out from loop()
+// once the copy is there
+static bool jitterPrintPending = false;
+static bool jitterSysExPending = false;
+
+void printJitterHistogram(const JitterHistogram &histogram)
+{
+  Serial.print("Emission jitter: ");
+  Serial.print(histogram.count);
+  Serial.print(" note-ons, avg ");
+  Serial.print(histogram.averageUs());
+  Serial.print(" us, max ");
+  Serial.print(histogram.maxUs);
+  Serial.println(" us");
+  for (int i = 0; i < jitterBucketCount; ++i)
+  {
+    if (i < jitterBucketCount - 1)
+    {
+      Serial.print("  <= ");
+      Serial.print(jitterBucketUpperUs[i]);
+    }
+    else
+    {
+      Serial.print("  >  ");
+      Serial.print(jitterBucketUpperUs[i - 1]);
+    }
+    Serial.print(" us: ");
+    Serial.println(histogram.buckets[i]);
+  }
+}
+
+// Append a 32-bit value as five 7-bit bytes, least significant first
+static size_t packSysex32(uint8_t *out, uint32_t value)
+{
+  for (int i = 0; i < 5; ++i)
+  {
+    out[i] = value & 0x7F;
+    value >>= 7;
+  }
+  return 5;
+}
+
+// F0 7D 11 <bucket count> <buckets...> <count> <max us> <avg us> F7
+void sendJitterSysEx(const JitterHistogram &histogram)
+{
+  uint8_t message[5 + 5 * (jitterBucketCount + 3)];
+  size_t length = 0;
+  message[length++] = 0xF0;
+  message[length++] = sysexManufacturerId;
+  message[length++] = SYSEX_JITTER_DATA;
+  message[length++] = jitterBucketCount;
+  for (int i = 0; i < jitterBucketCount; ++i)
+    length += packSysex32(message + length, histogram.buckets[i]);
+  length += packSysex32(message + length, histogram.count);
+  length += packSysex32(message + length, histogram.maxUs);
+  length += packSysex32(message + length, histogram.averageUs());
+  message[length++] = 0xF7;
+  sendSysEx(message, length);
+}
+
+void requestJitterReport(bool sysex)
+{
+  if (sysex)
+    jitterSysExPending = true;
+  else
+    jitterPrintPending = true;
+  stepSchedulerRequestJitter();
+}
+
+void pollJitterReports()
+{
+  JitterHistogram histogram;
+  if ((!jitterPrintPending && !jitterSysExPending) || !stepSchedulerJitter(histogram))
+    return;
+  if (jitterPrintPending)
+    printJitterHistogram(histogram);
+  if (jitterSysExPending)
+    sendJitterSysEx(histogram);
+  jitterPrintPending = false;
+  jitterSysExPending = false;
+}
+
+// --- LATENCY CALIBRATION ---
+// With an output looped back to an input (a DIN cable, or a MIDI thru in the
+// DAW for USB), a SysEx ping times the round trip. Less the ping's two extra
+// DIN bytes over a 3-byte note, that becomes the destination's latency.
+static uint64_t latencyPingSentUs[OUTPUT_DESTINATION_COUNT] = {};
+const uint32_t latencyPingTimeoutUs = 500000;
+
+void startLatencyCalibration(OutputDestination destination)
+{
+  const uint8_t ping[] = {0xF0, sysexManufacturerId, SYSEX_LATENCY_PING, static_cast<uint8_t>(destination), 0xF7};
+  latencyPingSentUs[destination] = timebaseNowUs();
+  sendSysExTo(destination, ping, sizeof(ping));
+  Serial.print("Latency ping sent on ");
+  Serial.println(outputDestinationNames[destination]);
+}
+
+static void handleLatencyPing(uint8_t destination)
+{
+  if (destination >= OUTPUT_DESTINATION_COUNT || latencyPingSentUs[destination] == 0)
+    return;
+  uint64_t roundTripUs = timebaseNowUs() - latencyPingSentUs[destination];
+  latencyPingSentUs[destination] = 0;
+  if (roundTripUs > latencyPingTimeoutUs)
+    return;
+  if (destination == OUTPUT_DIN)
+    roundTripUs = roundTripUs > 2 * midiOutByteUs ? roundTripUs - 2 * midiOutByteUs : 0;
+  outputLatencyUs[destination] = std::min<uint64_t>(roundTripUs, maxOutputLatencyUs);
+  Serial.print("Latency ");
+  Serial.print(outputDestinationNames[destination]);
+  Serial.print(": ");
+  Serial.print(outputLatencyUs[destination]);
+  Serial.println(" us (loopback)");
+}
+
+static bool parseOutputDestination(const char *name, OutputDestination &destination)
+{
+  for (int i = 0; i < OUTPUT_DESTINATION_COUNT; ++i)
+  {
+    if (strcasecmp(name, outputDestinationNames[i]) == 0)
+    {
+      destination = static_cast<OutputDestination>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+void printOutputLatency()
+{
+  for (int i = 0; i < OUTPUT_DESTINATION_COUNT; ++i)
+  {
+    Serial.print("Latency ");
+    Serial.print(outputDestinationNames[i]);
+    Serial.print(": ");
+    Serial.print(outputLatencyUs[i]);
+    Serial.println(" us");
+  }
+}
+
+// --- SYSEX ---
+void handleSysEx(const uint8_t *data, size_t length)
+{
+  if (length < 2 || data[0] != sysexManufacturerId)
+    return;
+  switch (data[1])
+  {
+  case SYSEX_JITTER_DUMP:
+    requestJitterReport(true);
+    break;
+  case SYSEX_JITTER_RESET:
+    stepSchedulerResetJitter();
+    break;
+  case SYSEX_LATENCY_PING:
+    if (length >= 3)
+      handleLatencyPing(data[2]);
+    break;
+  }
+}
+
+// --- SERIAL COMMANDS ---
+// Line commands on the USB serial console:
+//   jitter        print the emission jitter histogram
+//   jitter reset  clear it
+//   jitter sysex  send it as a SysEx dump on MIDI out
+//   profile       print per-stage loop() timings (build with -DARP_PROFILE)
+//   profile reset clear them
+//   latency                  print the per-output latencies
+//   latency din|usb <us>     set one
+//   latency cal din|usb      measure one over a loopback (output cabled to input)
+void handleSerialCommand(const char *command)
+{
+  OutputDestination destination = OUTPUT_DIN;
+  unsigned long latencyUs = 0;
+  char name[4];
+  if (strcmp(command, "jitter") == 0)
+    requestJitterReport(false);
+  else if (strcmp(command, "jitter reset") == 0)
+  {
+    stepSchedulerResetJitter();
+    Serial.println("Emission jitter reset");
+  }
+  else if (strcmp(command, "jitter sysex") == 0)
+    requestJitterReport(true);
+  else if (strcmp(command, "profile") == 0)
+    profilerReport();
+  else if (strcmp(command, "profile reset") == 0)
+  {
+    profilerReset();
+    Serial.println("Profile reset");
+  }
+  else if (strcmp(command, "latency") == 0)
+    printOutputLatency();
+  else if (sscanf(command, "latency cal %3s", name) == 1 && parseOutputDestination(name, destination))
+    startLatencyCalibration(destination);
+  else if (sscanf(command, "latency %3s %lu", name, &latencyUs) == 2 && parseOutputDestination(name, destination))
+  {
+    outputLatencyUs[destination] = std::min<unsigned long>(latencyUs, maxOutputLatencyUs);
+    printOutputLatency();
+  }
+  else
+  {
+    Serial.print("Unknown command: ");
+    Serial.println(command);
+  }
+}
+
+void pollSerialCommands()
+{
+  static char line[32];
+  static size_t lineLength = 0;
+  while (Serial.available())
+  {
+    char c = Serial.read();
+    if (c == '\r' || c == '\n')
+    {
+      if (lineLength > 0)
+      {
+        line[lineLength] = '\0';
+        handleSerialCommand(line);
+        lineLength = 0;
+      }
+    }
+    else if (lineLength < sizeof(line) - 1)
+    {
+      line[lineLength++] = c;
+    }
+  }
 }
 
 // --- NOTE LENGTH RANDOMIZATION FUNCTION ---
-// Returns a randomized note length (ms)
-unsigned long getRandomizedNoteLength(unsigned long noteLengthMs)
+// Returns a randomized note length (us)
+unsigned long getRandomizedNoteLength(unsigned long noteLengthUs)
 {
-  unsigned long maxShorten = noteLengthMs;
+  unsigned long maxShorten = noteLengthUs;
   unsigned long shortenAmount = (maxShorten * noteLengthRandomizePercent) / 100;
   if (shortenAmount == 0)
-    return noteLengthMs;
+    return noteLengthUs;
   unsigned long randomShorten = random(0, shortenAmount + 1);
-  return noteLengthMs - randomShorten;
+  return noteLengthUs - randomShorten;
 }
 
 // --- NOTE BIAS FUNCTION ---
@@ -362,6 +772,8 @@ void setup()
 
   pinMode(ledBuiltIn, OUTPUT);
   pinMode(clearButtonPin, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(clearButtonPin), onClearButtonEdge, FALLING);
+  attachInterrupt(digitalPinToInterrupt(encoderSW), onEncoderSwitchEdge, FALLING);
   
   Serial.begin(115200); // Debug
   unsigned long serialStart = millis();
@@ -371,6 +783,7 @@ void setup()
   }
   Serial1.begin(31250, SERIAL_8N1, midiInRxPin, -1);  // MIDI IN
   Serial2.begin(31250, SERIAL_8N1, -1, midiOutTxPin); // MIDI OUT
+  midiOutBegin(Serial2);
 
   USB.begin();
   usbMIDI.begin();
@@ -388,11 +801,13 @@ void setup()
   handleNoteOn(67);
   handleNoteOff(55);
 
-  // Initialize stepsPerBar and arpInterval
+  // Initialize stepsPerBar and the step period
   stepsPerBar = stepsPerBarOptions[stepsPerBarIndex];
-  unsigned long barLengthMs = 60000 / bpm * 4;
-  unsigned long noteLengthMs = barLengthMs / stepsPerBar;
-  arpInterval = noteLengthMs;
+  tempoSetTarget(bpm, stepsPerBar, barTicks, 0);
+  humanizeSeed(esp_random());
+
+  // Note emission runs from the step timer from here on
+  stepSchedulerBegin({sendNoteOn, sendNoteOff, mapOutputNote, sendRealtime, midiOutService, midiOutDeparted});
 }
 
 // --- LOOP ---
@@ -402,6 +817,7 @@ void loop()
   unsigned long now = millis();
 
   // --- Clear button handling ---
+  PROFILE_LAP_BEGIN(loopProfile, PROFILE_CLEAR_BUTTON);
   handleClearButton();
 
   /*
@@ -422,18 +838,36 @@ void loop()
   */
 
   // --- Encoder switch shift-register debounce ---
+  PROFILE_LAP(loopProfile, PROFILE_ENCODER);
   encoderSWDebounce = (encoderSWDebounce << 1) | !digitalRead(encoderSW);
   bool swDebounced = (encoderSWDebounce == 0xFFFF);
 
   static bool swHandled = false;
-  // Encoder switch short press: cycle encoder mode
+  static unsigned long swPressedAt = 0;
+  bool swTapping = tapping(TAP_ENCODER_SWITCH);
+  // Encoder switch short press: cycle encoder mode (or tap, holding to leave tap tempo)
   if (swDebounced && !swHandled)
+  {
+    swPressedAt = now;
+    if (swTapping)
+    {
+      handleTap(TAP_ENCODER_SWITCH);
+    }
+    else
+    {
+      encoderMode = static_cast<EncoderMode>((encoderMode + 1) % encoderModeSize);
+      neopixelWrite(ledBuiltIn, 0, 0, 127);
+      ledFlashStart = millis();
+      ledFlashing = true;
+    }
+    swHandled = true;
+  }
+  if (swDebounced && swTapping && now - swPressedAt >= tapModeExitHoldMs)
   {
     encoderMode = static_cast<EncoderMode>((encoderMode + 1) % encoderModeSize);
     neopixelWrite(ledBuiltIn, 0, 0, 127);
     ledFlashStart = millis();
     ledFlashing = true;
-    swHandled = true;
   }
   if (!swDebounced)
   {
@@ -464,10 +898,10 @@ void loop()
     switch (encoderMode)
     {
     case MODE_BPM:
-      bpm = constrain(bpm + delta, 40, 240);
+      bpm = constrain(bpm + delta, 40.0f, 240.0f);
       break;
     case MODE_LENGTH:
-      noteLengthPercent = constrain(noteLengthPercent + delta * 5, 5, 100);
+      noteLengthPercent = constrain(noteLengthPercent + delta * 5, 5, maxNoteLengthPercent);
       break;
     case MODE_VELOCITY:
       noteVelocity = constrain(noteVelocity + delta, 1, 127);
@@ -521,6 +955,15 @@ void loop()
     case MODE_REPEAT:
       noteRepeat = constrain(noteRepeat + delta, 1, 4);
       break;
+    case MODE_RATCHET:
+      ratchetHits = constrain(ratchetHits + delta, 1, maxRatchetHits);
+      break;
+    case MODE_RATCHET_PROBABILITY:
+      ratchetPercent = constrain(ratchetPercent + delta, 0, 100);
+      break;
+    case MODE_RATCHET_DECAY:
+      ratchetDecayPercent = constrain(ratchetDecayPercent + delta, 0, 100);
+      break;
     case MODE_TRANSPOSE:
       transpose = constrain(transpose + delta, minTranspose, maxTranspose);
       break;
@@ -531,6 +974,17 @@ void loop()
       timingHumanizePercent = constrain(timingHumanizePercent + delta, 0, maxTimingHumanizePercent);
       timingHumanize = (timingHumanizePercent > 0);
       break;
+    case MODE_TAP_TEMPO:
+      tapInput = static_cast<TapInput>(constrain(tapInput + delta, 0, TAP_INPUT_COUNT - 1));
+      tapTempo.reset();
+      Serial.print("Tap Input: ");
+      Serial.println(tapInputNames[tapInput]);
+      break;
+    case MODE_HUMANIZE_PROFILE:
+      humanizeProfile = static_cast<HumanizeProfile>(constrain(humanizeProfile + delta, 0, HUMANIZE_PROFILE_COUNT - 1));
+      Serial.print("Humanize Profile: ");
+      Serial.println(humanizeProfileNames[humanizeProfile]);
+      break;
     case MODE_LENGTH_RANDOMIZE:
       noteLengthRandomizePercent = constrain(noteLengthRandomizePercent + delta, 0, maxNoteLengthRandomizePercent);
       break;
@@ -575,20 +1029,101 @@ void loop()
       Serial.print("MODE_BAR: ");
       Serial.println(modeBar ? "FIT" : "NORMAL");
       break;
+    case MODE_INPUT:
+      chordInputMode = static_cast<ChordInputMode>(constrain(chordInputMode + delta, 0, CHORD_INPUT_COUNT - 1));
+      heldChordDirty = true;
+      Serial.print("Chord Input Mode: ");
+      Serial.println(chordInputModeNames[chordInputMode]);
+      break;
+    case MODE_VOICING:
+      voiceLeading = !voiceLeading;
+      Serial.print("Voice Leading: ");
+      Serial.println(voiceLeading ? "ON" : "OFF");
+      break;
+    case MODE_CHORD_FILL:
+      chordFill = !chordFill;
+      Serial.print("Chord Fill: ");
+      Serial.println(chordFill ? "ON" : "OFF");
+      break;
+    case MODE_SCALE:
+      scaleType = static_cast<ScaleType>(constrain(scaleType + delta, 0, SCALE_COUNT - 1));
+      scaleMap = scaleQuantizeTable(scaleType, scaleRoot);
+      Serial.print("Scale: ");
+      Serial.println(scaleNames[scaleType]);
+      break;
+    case MODE_SCALE_ROOT:
+      scaleRoot = (scaleRoot + delta + 12) % 12;
+      scaleMap = scaleQuantizeTable(scaleType, scaleRoot);
+      Serial.print("Scale Root: ");
+      Serial.println(pitchClassNames[scaleRoot]);
+      break;
+    case MODE_TRANSPOSE_CHANNEL:
+      transposeChannel = constrain(transposeChannel + delta, 0, 16);
+      if (transposeChannel == 0 && transposeSplitNote == 0)
+        liveTranspose = 0;
+      break;
+    case MODE_GROOVE:
+      grooveType = static_cast<GrooveType>(constrain(grooveType + delta, 0, GROOVE_COUNT - 1));
+      Serial.print("Groove: ");
+      Serial.println(grooveNames[grooveType]);
+      break;
+    case MODE_SWING:
+      swingPercent = constrain(swingPercent + delta, minSwingPercent, maxSwingPercent);
+      break;
+    case MODE_TEMPO_RAMP:
+      tempoRampBeats = constrain(tempoRampBeats + delta, 0, maxTempoRampBeats);
+      break;
+    case MODE_SYNC:
+      syncMode = static_cast<SyncMode>(constrain(syncMode + delta, 0, SYNC_MODE_COUNT - 1));
+      Serial.print("Sync: ");
+      Serial.println(syncModeNames[syncMode]);
+      break;
+    case MODE_CLOCK_SOURCE:
+      clockSourceSelect = static_cast<ClockSourceSelect>(constrain(clockSourceSelect + delta, 0, CLOCK_SELECT_COUNT - 1));
+      Serial.print("Clock Source: ");
+      Serial.println(clockSourceSelectNames[clockSourceSelect]);
+      break;
+    case MODE_CLOCK_RATIO:
+      clockRatio = static_cast<ClockRatio>(constrain(clockRatio + delta, 0, CLOCK_RATIO_COUNT - 1));
+      Serial.print("Clock Ratio: ");
+      Serial.println(clockRatioNames[clockRatio]);
+      break;
+    case MODE_TIME_SIGNATURE:
+      timeSignatureIndex = constrain(timeSignatureIndex + delta, 0, timeSignatureOptionsSize - 1);
+      barTicks = barTicksFor(timeSignatureOptions[timeSignatureIndex]);
+      Serial.print("Time Signature: ");
+      Serial.print(timeSignatureOptions[timeSignatureIndex].numerator);
+      Serial.print("/");
+      Serial.println(timeSignatureOptions[timeSignatureIndex].denominator);
+      break;
+    case MODE_POLYMETER:
+      polymeterSteps = constrain(polymeterSteps + delta, 0, maxPolymeterSteps);
+      break;
     }
-    // Update arpInterval to reflect the note length for a 4/4 bar
-    unsigned long barLengthMs = 60000 / bpm * 4;
-    unsigned long noteLengthMs = barLengthMs / stepsPerBar;
-    arpInterval = noteLengthMs;
   }
 
   // --- MIDI IN (hardware) ---
+  PROFILE_LAP(loopProfile, PROFILE_MIDI_IN);
   while (Serial1.available())
     readMidiByte(Serial1.read());
 
   // --- MIDI IN (USB) ---
+  PROFILE_LAP(loopProfile, PROFILE_USB_IN);
   processUsbMidiPackets(usbMIDI);
 
+  // --- MIDI OUT: keep the UART fed (the step timer does too) ---
+  midiOutService();
+
+  // --- Serial console commands ---
+  PROFILE_LAP(loopProfile, PROFILE_SERIAL_COMMANDS);
+  pollSerialCommands();
+  pollJitterReports();
+
+  // --- Held-notes mode: derive the chord from the key-state table ---
+  PROFILE_LAP(loopProfile, PROFILE_CHORD_INPUT);
+  if (chordInputMode == HELD && heldChordDirty)
+    rebuildHeldChord();
+
   // --- Chord processing ---
   // baseChord: The chord as currently being played or captured (raw input, possibly with duplicates, order preserved).
   std::vector<uint8_t> baseChord = capturingChord ? tempChord : currentChord;
@@ -603,7 +1138,28 @@ void loop()
   // Remove duplicates from orderedChord
   orderedChord.erase(std::unique(orderedChord.begin(), orderedChord.end()), orderedChord.end());
 
+  // --- Chord recognition: a single table lookup on the pitch-class mask ---
+  uint16_t chordMask = pitchClassMask(orderedChord);
+  ChordInfo detectedChord = recognizeChord(chordMask);
+
+  // --- Chord fill: add missing chord tones above the lowest note ---
+  if (chordFill && detectedChord.type != CHORD_NONE && detectedChord.missing > 0)
+  {
+    uint16_t missingMask = chordTemplateMask(detectedChord.type, detectedChord.root) & ~chordMask;
+    uint8_t lowest = orderedChord.front();
+    for (int pc = 0; pc < 12; ++pc)
+    {
+      if (!(missingMask & (1 << pc)))
+        continue;
+      int note = lowest + (pc - lowest % 12 + 12) % 12;
+      if (note <= 127)
+        orderedChord.push_back(note);
+    }
+    std::sort(orderedChord.begin(), orderedChord.end());
+  }
+
   // --- Apply range shift to orderedChord before building pattern indices ---
+  PROFILE_LAP(loopProfile, PROFILE_CHORD_PATTERN);
   // When noteRangeShift > 0, shift up by removing the lowest note and adding oldLowest+12 (clamped), for each step.
   // When noteRangeShift < 0, shift down by removing the highest note and adding oldHighest-12 (clamped), for each step.
   std::vector<uint8_t> shiftedChord = orderedChord;
@@ -791,10 +1347,12 @@ void loop()
   applyNoteBiasToChord(playingChord, noteBalancePercent);
 
   // --- Apply MODE_BAR functionality ---
-  if (modeBar)
+  // Polymeter fits the pattern to its own step count instead, so it cycles
+  // against the bar (e.g. 5 notes over 4/4 at 16 steps)
+  if ((modeBar || polymeterSteps > 0) && !playingChord.empty())
   {
     std::vector<uint8_t> adjustedPlayingChord;
-    size_t steps = stepsPerBar;
+    size_t steps = polymeterSteps > 0 ? polymeterSteps : stepsPerBar;
 
     if (playingChord.size() > steps)
     {
@@ -814,100 +1372,100 @@ void loop()
   }
 
   // --- Build stepNotes for random chord steps ---
+  PROFILE_LAP(loopProfile, PROFILE_RANDOM_CHORDS);
   std::vector<StepNotes> stepNotes;
-  buildRandomChordSteps(stepNotes, playingChord, playedChord, randomChordPercent);
-
-  // --- Arpeggiator timing and note scheduling ---
-  static int timingOffset = 0;
-  static unsigned long nextNoteTime = 0;
-
-  unsigned long noteLengthMs = arpInterval * noteLengthPercent / 100;
-  unsigned long randomizedNoteLengthMs = getRandomizedNoteLength(noteLengthMs);
-
-  if (nextNoteTime == 0)
-    nextNoteTime = now;
-
-  uint8_t velocityToSend = noteVelocity;
-
-  // --- Note scheduling: play next note/chord if ready ---
-  static std::vector<uint8_t> notesOn;
-  if (!noteOnActive && !stepNotes.empty() && now >= nextNoteTime)
+  buildRandomChordSteps(stepNotes, playingChord, playedChord, randomChordPercent, voiceLeading);
+
+  // --- Tempo: the only place step timing is derived from bpm, steps per bar and time signature ---
+  PROFILE_LAP(loopProfile, PROFILE_STEP_RENDER);
+  tempoSetTarget(bpm, stepsPerBar, barTicks, tempoRampBeats);
+  uint64_t stepPeriodQ32 = tempoStepPeriodQ32();
+  // Slaved: steps land on exact clock ticks while a source is running; with
+  // none, timing carries on from the internal tempo at the last clock tempo
+  stepSchedulerFollowClock(syncMode == SYNC_FOLLOW ? activeClockTracker(timebaseNowUs()) : nullptr);
+  // Leaving clock follow drops a Stop taken from the external clock: nothing
+  // would send Start any more. A clock that only times out keeps it stopped.
+  static SyncMode lastSyncMode = syncMode;
+  if (lastSyncMode == SYNC_FOLLOW && syncMode != SYNC_FOLLOW && stepSchedulerStopped())
+    stepSchedulerStart(0);
+  lastSyncMode = syncMode;
+  stepSchedulerSendClock(syncMode == SYNC_MASTER);
+  for (int i = 0; i < OUTPUT_DESTINATION_COUNT; ++i)
+    stepSchedulerSetLatency(i, outputLatencyUs[i]);
+
+  // --- Resolve the groove when tempo, steps or groove change ---
+  static uint64_t grooveResolvedPeriodQ32 = 0;
+  static GrooveType grooveResolvedType = GROOVE_COUNT;
+  static int grooveResolvedSwing = 0;
+  if (stepPeriodQ32 != grooveResolvedPeriodQ32 || grooveType != grooveResolvedType || swingPercent != grooveResolvedSwing)
   {
-    size_t chordSize = stepNotes.size();
-    size_t noteIndex = currentNoteIndex % chordSize;
-    notesOn = stepNotes[noteIndex].notes;
+    buildGrooveTable(grooveTable, grooveType, swingPercent, periodWholeUs(stepPeriodQ32));
+    grooveResolvedPeriodQ32 = stepPeriodQ32;
+    grooveResolvedType = grooveType;
+    grooveResolvedSwing = swingPercent;
+  }
 
-    // Print step and note information
-    // Serial.print("step-note: ");
-    // Serial.print(currentNoteIndex + 1); // Step number (1-based index)
-    // Serial.print("-");
-    // Serial.println(noteIndex + 1); // Note number (1-based index)
+  // --- Render the step table for the timer-driven scheduler ---
+  // Everything random (velocity dynamics, length, humanize) is resolved here; publishing
+  // renders the next steps into the look-ahead event queue, well before their deadline.
+  StepTable &table = stepSchedulerBackTable();
+  table.size = std::min(stepNotes.size(), maxScheduledSteps);
+  table.repeat = noteRepeat;
+  table.groove = &grooveTable;
+
+  unsigned long noteLengthUs = (uint64_t)periodWholeUs(stepPeriodQ32) * noteLengthPercent / 100;
+  // Timing humanize spread, drawn per step by the scheduler
+  table.humanize = humanizeProfile;
+  table.humanizeRangeUs = timingHumanize ? (uint64_t)noteLengthUs * timingHumanizePercent / 100 : 0;
+
+  // --- Rhythm velocity calculation using pattern generator ---
+  // Invert mapping: 0 is loudest (1.0), max is softest (0.1)
+  std::vector<uint8_t> rhythmPatternIndices = customPatternFuncs[selectedRhythmPattern](table.size);
+  uint8_t minIdx = 0, maxIdx = 0;
+  if (!rhythmPatternIndices.empty())
+  {
+    minIdx = *std::min_element(rhythmPatternIndices.begin(), rhythmPatternIndices.end());
+    maxIdx = *std::max_element(rhythmPatternIndices.begin(), rhythmPatternIndices.end());
+  }
 
-    // --- Rhythm velocity calculation using pattern generator ---
-    std::vector<uint8_t> rhythmPatternIndices = customPatternFuncs[selectedRhythmPattern](chordSize);
-    // Invert mapping: 0 is loudest (1.0), max is softest (0.1)
+  for (size_t i = 0; i < table.size; ++i)
+  {
+    ScheduledStep &step = table.steps[i];
     float rhythmMult = 1.0f;
-    if (!rhythmPatternIndices.empty())
+    if (maxIdx > minIdx)
     {
-      std::vector<uint8_t> sortrhythmPatternIndices = rhythmPatternIndices;
-      std::sort(sortrhythmPatternIndices.begin(), sortrhythmPatternIndices.end());
-      // uint8_t targetNote = (percent < 0) ? sortChord.front() : sortChord.back();
-
-      uint8_t minIdx = sortrhythmPatternIndices.front();
-      uint8_t maxIdx = sortrhythmPatternIndices.back();
-
-      // uint8_t minIdx = *std::min_element(rhythmPatternIndices.begin(), rhythmPatternIndices.end());
-      // uint8_t maxIdx = *std::max_element(rhythmPatternIndices.begin(), rhythmPatternIndices.end());
-      uint8_t idx = rhythmPatternIndices[noteIndex % rhythmPatternIndices.size()];
-      if (maxIdx > minIdx)
-      {
-        // Inverted: 0 -> 1.0, max -> 0.1
-        rhythmMult = 1.0f - 0.9f * (float)(idx - minIdx) / (float)(maxIdx - minIdx);
-        rhythmMult = std::max(0.1f, rhythmMult); // Clamp to at least 0.1
-      }
-      else
-      {
-        rhythmMult = 1.0f;
-      }
+      uint8_t idx = rhythmPatternIndices[i % rhythmPatternIndices.size()];
+      rhythmMult = 1.0f - 0.9f * (float)(idx - minIdx) / (float)(maxIdx - minIdx);
+      rhythmMult = std::max(0.1f, rhythmMult); // Clamp to at least 0.1
     }
     uint8_t rhythmVelocity = constrain((int)(noteVelocity * rhythmMult), 64, 127);
 
-    // Send all notes in this step (chord or single note)
-    for (uint8_t n : notesOn)
+    // All notes in this step (chord or single note)
+    const std::vector<uint8_t> &notes = stepNotes[i].notes;
+    step.noteCount = std::min(notes.size(), maxNotesPerStep);
+    for (size_t k = 0; k < step.noteCount; ++k)
     {
-      int transposedNote = constrain(n + 12 * transpose, 0, 127);
       uint8_t v = rhythmVelocity;
       if (velocityDynamicsPercent > 0)
       {
         int maxAdjustment = (v * velocityDynamicsPercent) / 100;
         v = constrain(v - random(0, maxAdjustment + 1), 64, 127);
       }
-      sendNoteOn(transposedNote, v);
+      step.notes[k] = notes[k];
+      step.velocities[k] = v;
     }
-
-    timingOffset = (timingHumanize ? getTimingHumanizeOffset(noteLengthMs) : 0);
-    noteOnStartTime = now + timingOffset;
-    noteOnActive = true;
-    nextNoteTime += arpInterval;
+    step.lengthUs = getRandomizedNoteLength(noteLengthUs);
+    // Ratchet: the scheduler spreads the hits evenly over the step's span
+    step.ratchet = (ratchetHits > 1 && random(0, 100) < ratchetPercent) ? ratchetHits : 1;
+    step.ratchetDecayPercent = ratchetDecayPercent;
   }
 
-  // Send note off after note duration for all notes in the step
-  if (noteOnActive && now >= noteOnStartTime + randomizedNoteLengthMs)
-  {
-    for (uint8_t n : notesOn)
-    {
-      int transposedNote = constrain(n + 12 * transpose, 0, 127);
-      sendNoteOff(transposedNote);
-    }
-    noteOnActive = false;
-    if (++noteRepeatCounter >= noteRepeat)
-    {
-      noteRepeatCounter = 0;
-      currentNoteIndex = (currentNoteIndex + 1) % stepNotes.size();
-    }
-  }
+  // Latch-add / held: remap the position proportionally when the length changes
+  PROFILE_LAP(loopProfile, PROFILE_STEP_EMISSION);
+  stepSchedulerPublish(chordInputMode != LATCH);
 
   // --- LED flash timing ---
+  PROFILE_LAP(loopProfile, PROFILE_LED);
   if (ledFlashing && now - ledFlashStart >= ledFlashDuration)
   {
     neopixelWrite(ledBuiltIn, 0, 0, 0);
@@ -915,7 +1473,10 @@ void loop()
   }
 
   // --- Serial debug output for parameter changes ---
-  static int lastBPM = bpm, lastLength = noteLengthPercent, lastVelocity = noteVelocity, lastOctave = octaveRange;
+  PROFILE_LAP(loopProfile, PROFILE_DEBUG_PRINT);
+  static float lastBPM = bpm;
+  const float bpmPrintThreshold = 0.1f;
+  static int lastLength = noteLengthPercent, lastVelocity = noteVelocity, lastOctave = octaveRange;
   static int lastNoteRepeat = noteRepeat, lastTranspose = transpose;
   static EncoderMode lastMode = encoderMode;
   static int lastUseVelocityDynamics = velocityDynamicsPercent;
@@ -928,8 +1489,17 @@ void loop()
   static int lastNoteRangeShift = noteRangeShift;
   static int lastNoteRangeStretch = noteRangeStretch;
   static int lastStepsPerBarIndex = stepsPerBarIndex;
-
-  printIfChanged("BPM: ", lastBPM, bpm, bpm);
+  static int lastTransposeChannel = transposeChannel;
+  static int lastLiveTranspose = liveTranspose;
+  static int lastSwingPercent = swingPercent;
+  static int lastTempoRampBeats = tempoRampBeats;
+  static int lastPolymeterSteps = polymeterSteps;
+  static int lastRatchetHits = ratchetHits, lastRatchetPercent = ratchetPercent;
+  static int lastRatchetDecayPercent = ratchetDecayPercent;
+
+  // Following clock refreshes bpm every tick: report moves of 0.1 BPM or more, not every wobble
+  if (fabsf(bpm - lastBPM) >= bpmPrintThreshold)
+    printIfChanged("BPM: ", lastBPM, bpm, bpm);
   printIfChanged("Note Length %: ", lastLength, noteLengthPercent, noteLengthPercent);
   printIfChanged("Velocity: ", lastVelocity, noteVelocity, noteVelocity);
   printIfChanged("Octave Range: ", lastOctave, octaveRange, octaveRange);
@@ -943,7 +1513,55 @@ void loop()
   printIfChanged("Rhythm Pattern: ", lastRhythmPattern, selectedRhythmPattern, selectedRhythmPattern);
   printIfChanged("Range Shift: ", lastNoteRangeShift, noteRangeShift, noteRangeShift);
   printIfChanged("Range Stretch: ", lastNoteRangeStretch, noteRangeStretch, noteRangeStretch);
-  printIfChanged("Steps (4/4 bar): ", lastStepsPerBarIndex, stepsPerBarIndex, stepsPerBarOptions[stepsPerBarIndex]);
+  printIfChanged("Steps per bar: ", lastStepsPerBarIndex, stepsPerBarIndex, stepsPerBarOptions[stepsPerBarIndex]);
+  printIfChanged("Transpose Channel: ", lastTransposeChannel, (int)transposeChannel, (int)transposeChannel);
+  printIfChanged("Live Transpose: ", lastLiveTranspose, liveTranspose, liveTranspose);
+  printIfChanged("Swing %: ", lastSwingPercent, swingPercent, swingPercent);
+  printIfChanged("Tempo Ramp (beats): ", lastTempoRampBeats, tempoRampBeats, tempoRampBeats);
+  printIfChanged("Polymeter Steps: ", lastPolymeterSteps, polymeterSteps, polymeterSteps);
+  printIfChanged("Ratchet Hits: ", lastRatchetHits, ratchetHits, ratchetHits);
+  printIfChanged("Ratchet Probability %: ", lastRatchetPercent, ratchetPercent, ratchetPercent);
+  printIfChanged("Ratchet Decay %: ", lastRatchetDecayPercent, ratchetDecayPercent, ratchetDecayPercent);
+
+  // Scheduler counters: report whenever another event goes out late
+  SchedulerStats schedulerStats = stepSchedulerStats();
+  static uint32_t lastLateEvents = 0;
+  if (schedulerStats.late != lastLateEvents)
+  {
+    Serial.print("Late events: ");
+    Serial.print(schedulerStats.late);
+    Serial.print("/");
+    Serial.print(schedulerStats.dispatched);
+    Serial.print(", queue depth ");
+    Serial.print(schedulerStats.depth);
+    Serial.print(" (max ");
+    Serial.print(schedulerStats.maxDepth);
+    Serial.println(")");
+    lastLateEvents = schedulerStats.late;
+  }
+
+  static ClockSource lastClockSource = CLOCK_SOURCE_NONE;
+  if (activeClockSource != lastClockSource)
+  {
+    const char *clockSourceNames[CLOCK_SOURCE_COUNT] = {"DIN", "USB"};
+    Serial.print("Clock In: ");
+    Serial.println(activeClockSource == CLOCK_SOURCE_NONE ? "none" : clockSourceNames[activeClockSource]);
+    lastClockSource = activeClockSource;
+  }
+
+  static uint16_t lastChordMask = 0;
+  if (chordMask != lastChordMask)
+  {
+    Serial.print("Chord: ");
+    if (detectedChord.type == CHORD_NONE)
+      Serial.println("-");
+    else
+    {
+      Serial.print(pitchClassNames[detectedChord.root]);
+      Serial.println(chordTypeNames[detectedChord.type]);
+    }
+    lastChordMask = chordMask;
+  }
 
   if (encoderMode != lastMode)
   {
@@ -0,0 +1,98 @@
+#include <unity.h>
+#include "ClockTracker.h"
+
+// --- CLOCK TRACKER (host) ---
+// Synthetic 24 PPQN streams at 120 BPM: clean, jittered, with a dropped
+// tick and with a stray duplicate tick.
+
+const float tickPeriodUs = 60000000.0f / (clockTicksPerBeat * 120.0f);
+const uint64_t streamStartUs = 1000000;
+
+static ClockTracker tracker;
+static uint32_t noiseState = 1;
+
+static uint64_t idealTickUs(uint32_t tick)
+{
+    return streamStartUs + static_cast<uint64_t>(tick * tickPeriodUs + 0.5f);
+}
+
+// Uniform timestamp noise in [-rangeUs, rangeUs], reproducible
+static int32_t noiseUs(int32_t rangeUs)
+{
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return static_cast<int32_t>((noiseState >> 8) % (2 * rangeUs + 1)) - rangeUs;
+}
+
+static void feedTicks(uint32_t firstTick, uint32_t count, int32_t jitterUs)
+{
+    for (uint32_t tick = firstTick; tick < firstTick + count; ++tick)
+        tracker.tick(idealTickUs(tick) + (jitterUs ? noiseUs(jitterUs) : 0));
+}
+
+void setUp()
+{
+    tracker.reset();
+    noiseState = 1;
+}
+
+void tearDown()
+{
+}
+
+void test_locks_within_a_few_ticks()
+{
+    feedTicks(0, ClockTracker::lockTicks + 1, 0);
+    TEST_ASSERT_FALSE(tracker.locked());
+    feedTicks(ClockTracker::lockTicks + 1, 1, 0);
+    TEST_ASSERT_TRUE(tracker.locked());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 120.0f, tracker.bpm());
+    TEST_ASSERT_INT32_WITHIN(1, idealTickUs(ClockTracker::lockTicks + 2), tracker.nextTickUs());
+}
+
+// +-1 ms of timestamp jitter (about 5% of a tick): tempo and phase stay close
+void test_rejects_jitter()
+{
+    feedTicks(0, 24 * 16, 1000);
+    TEST_ASSERT_TRUE(tracker.locked());
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 120.0f, tracker.bpm());
+    uint32_t next = tracker.tickCount();
+    for (uint32_t tick = next; tick < next + 24 * 4; ++tick)
+    {
+        TEST_ASSERT_INT32_WITHIN(400, idealTickUs(tick), tracker.nextTickUs());
+        feedTicks(tick, 1, 1000);
+    }
+}
+
+// A missing tick is bridged: numbering and phase carry on
+void test_bridges_dropped_tick()
+{
+    feedTicks(0, 48, 0);
+    feedTicks(49, 24, 0);
+    TEST_ASSERT_TRUE(tracker.locked());
+    TEST_ASSERT_EQUAL_UINT32(73, tracker.tickCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 120.0f, tracker.bpm());
+    TEST_ASSERT_INT32_WITHIN(1, idealTickUs(73), tracker.nextTickUs());
+}
+
+// A stray tick between two real ones is rejected without disturbing tempo or numbering
+void test_rejects_outlier()
+{
+    feedTicks(0, 48, 0);
+    tracker.tick(idealTickUs(47) + 3000);
+    TEST_ASSERT_EQUAL_UINT32(48, tracker.tickCount());
+    feedTicks(48, 24, 0);
+    TEST_ASSERT_TRUE(tracker.locked());
+    TEST_ASSERT_EQUAL_UINT32(72, tracker.tickCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 120.0f, tracker.bpm());
+    TEST_ASSERT_INT32_WITHIN(1, idealTickUs(72), tracker.nextTickUs());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_locks_within_a_few_ticks);
+    RUN_TEST(test_rejects_jitter);
+    RUN_TEST(test_bridges_dropped_tick);
+    RUN_TEST(test_rejects_outlier);
+    return UNITY_END();
+}
@@ -0,0 +1,241 @@
+#include <unity.h>
+#include "StepScheduler.h"
+#include "Groove.h"
+#include "Constants.h"
+#include "Tempo.h"
+#include "Timebase.h"
+#include "ClockTracker.h"
+
+// --- STEP SCHEDULER (host) ---
+// Drives the scheduler the way loop() does, one pass per simulated
+// millisecond, with the simulated timer standing in for esp_timer.
+
+// Shared with main.cpp on target
+int stepsPerBar = 4;
+int barTicks = 96;
+ClockRatio clockRatio = CLOCK_RATIO_NORMAL;
+size_t currentNoteIndex = 0;
+int noteRepeatCounter = 0;
+
+const size_t maxRecordedNotes = 64;
+static uint64_t noteOnUs[maxRecordedNotes];
+static size_t noteOnCount = 0;
+static uint64_t latestNoteOnUs = 0; // Worst note-on time past its due time
+static uint64_t simNowUs = 0;
+static const GrooveTable *groove = nullptr;
+static HumanizeProfile humanize = HUMANIZE_UNIFORM;
+static uint32_t humanizeRangeUs = 0;
+static ClockTracker *followedClock = nullptr; // Fed 120 BPM ticks while set
+static uint64_t nextClockUs = 0;
+
+static bool recordNoteOn(uint8_t destination, uint8_t note, uint8_t velocity, uint64_t dueUs)
+{
+    uint64_t nowUs = timebaseNowUs();
+    if (destination == 0 && noteOnCount < maxRecordedNotes)
+        noteOnUs[noteOnCount++] = nowUs;
+    if (nowUs > dueUs && nowUs - dueUs > latestNoteOnUs)
+        latestNoteOnUs = nowUs - dueUs;
+    return false;
+}
+
+static void ignoreNoteOff(uint8_t destination, uint8_t note)
+{
+}
+
+const size_t maxRecordedClocks = 32;
+static uint64_t clockUs[maxOutputDestinations][maxRecordedClocks];
+static size_t clockCount[maxOutputDestinations] = {};
+
+static void recordRealtime(uint8_t destination, uint8_t status)
+{
+    if (status == 0xF8 && clockCount[destination] < maxRecordedClocks)
+        clockUs[destination][clockCount[destination]++] = timebaseNowUs();
+}
+
+// loop(): render a one-note table, publish it and let the timer catch up
+static void runFor(uint64_t durationUs)
+{
+    for (uint64_t endUs = simNowUs + durationUs; simNowUs < endUs; simNowUs += 1000)
+    {
+        for (; followedClock && nextClockUs <= simNowUs; nextClockUs += 20833)
+            followedClock->tick(nextClockUs);
+        stepSchedulerFollowClock(followedClock);
+        StepTable &table = stepSchedulerBackTable();
+        table.steps[0] = {1, {60}, {100}, 100000, 1, 0};
+        table.size = 1;
+        table.repeat = 1;
+        table.groove = groove;
+        table.humanize = humanize;
+        table.humanizeRangeUs = humanizeRangeUs;
+        stepSchedulerPublish(false);
+        stepSchedulerSimulate(simNowUs + 1000);
+    }
+}
+
+// loop() blocked: only the timer runs
+static void stallUntil(uint64_t untilUs)
+{
+    stepSchedulerSimulate(untilUs);
+    simNowUs = untilUs;
+}
+
+void setUp()
+{
+    noteOnCount = 0;
+    latestNoteOnUs = 0;
+}
+
+void tearDown()
+{
+}
+
+// 120 BPM, 4 steps over a 4/4 bar: a note every 500 ms
+void test_step_spacing()
+{
+    tempoSetTarget(120.0f, stepsPerBar, barTicks, 0);
+    runFor(3000000);
+    TEST_ASSERT_GREATER_OR_EQUAL(5, noteOnCount);
+    // The first step starts the grid at the first render; the idle poll picks it up
+    for (size_t i = 2; i < noteOnCount; ++i)
+        TEST_ASSERT_UINT32_WITHIN(1, 500000, static_cast<uint32_t>(noteOnUs[i] - noteOnUs[i - 1]));
+    TEST_ASSERT_EQUAL_UINT32(0, stepSchedulerStats().late);
+}
+
+// A loop() stall past a step's time: the step goes out late and is counted late
+void test_stall_counts_late()
+{
+    while (noteOnCount == 0)
+        runFor(1000);
+    runFor(150000); // Past the note-off, so only the next note-on can be late
+    uint32_t lateBefore = stepSchedulerStats().late;
+    stallUntil(noteOnUs[0] + 600000); // The next step was due at +500 ms
+    runFor(100000);
+    TEST_ASSERT_EQUAL(2, noteOnCount);
+    TEST_ASSERT_UINT32_WITHIN(1000, 100000, static_cast<uint32_t>(noteOnUs[1] - noteOnUs[0] - 500000));
+    TEST_ASSERT_GREATER_THAN(lateBefore, stepSchedulerStats().late);
+}
+
+// Push at 40 BPM, 8 steps: off-beats 45 ms early, more than the look-ahead
+void test_groove_lead_beyond_lookahead()
+{
+    static GrooveTable push;
+    stepsPerBar = 8;
+    tempoSetTarget(40.0f, stepsPerBar, barTicks, 0);
+    buildGrooveTable(push, GROOVE_PUSH, minSwingPercent, 750000);
+    TEST_ASSERT_EQUAL_UINT32(45000, push.leadUs);
+    groove = &push;
+    runFor(2000000);
+    noteOnCount = 0;
+    runFor(6000000);
+    groove = nullptr;
+    stepsPerBar = 4;
+
+    TEST_ASSERT_GREATER_OR_EQUAL(7, noteOnCount);
+    uint32_t shortest = UINT32_MAX;
+    for (size_t i = 1; i < noteOnCount; ++i)
+    {
+        uint32_t intervalUs = static_cast<uint32_t>(noteOnUs[i] - noteOnUs[i - 1]);
+        if (intervalUs < shortest)
+            shortest = intervalUs;
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, 750000 - 45000, shortest);
+}
+
+// Stop holds through a clock timeout; leaving clock follow resumes (main.cpp
+// starts the scheduler on the sync-mode change)
+void test_stop_holds_until_sync_change()
+{
+    static ClockTracker clock;
+    tempoSetTarget(120.0f, stepsPerBar, barTicks, 0);
+    followedClock = &clock;
+    nextClockUs = simNowUs;
+    runFor(1000000);
+    TEST_ASSERT_TRUE(clock.locked());
+    TEST_ASSERT_GREATER_THAN(0, noteOnCount);
+
+    stepSchedulerStop();
+    runFor(100000);
+    size_t stoppedCount = noteOnCount;
+    runFor(1000000);
+    TEST_ASSERT_TRUE(stepSchedulerStopped());
+    TEST_ASSERT_EQUAL(stoppedCount, noteOnCount);
+
+    followedClock = nullptr;
+    runFor(1000000);
+    TEST_ASSERT_TRUE(stepSchedulerStopped());
+    TEST_ASSERT_EQUAL(stoppedCount, noteOnCount);
+
+    stepSchedulerStart(0);
+    runFor(1000000);
+    TEST_ASSERT_FALSE(stepSchedulerStopped());
+    TEST_ASSERT_GREATER_OR_EQUAL(stoppedCount + 2, noteOnCount);
+}
+
+// Drift humanize up to a quarter step on top of Push at 40 BPM, 4 steps: the
+// render lead covers every early draw, so no note-on is clamped to now
+void test_early_draws_keep_their_time()
+{
+    static GrooveTable push;
+    tempoSetTarget(40.0f, stepsPerBar, barTicks, 0);
+    runFor(3000000);
+    buildGrooveTable(push, GROOVE_PUSH, minSwingPercent, 1500000);
+    groove = &push;
+    humanize = HUMANIZE_DRIFT;
+    humanizeRangeUs = 375000;
+    latestNoteOnUs = 0;
+    noteOnCount = 0;
+    runFor(30000000);
+    groove = nullptr;
+    humanizeRangeUs = 0;
+
+    TEST_ASSERT_GREATER_OR_EQUAL(18, noteOnCount);
+    TEST_ASSERT_EQUAL_UINT32(0, latestNoteOnUs);
+}
+
+// Clock master with DIN 960 us late: its clock bytes leave that much before
+// USB's, tick for tick, like its notes
+void test_clock_shifted_per_destination()
+{
+    tempoSetTarget(120.0f, stepsPerBar, barTicks, 0);
+    stepSchedulerSetLatency(0, 960);
+    stepSchedulerSendClock(true);
+    runFor(2000000);
+    clockCount[0] = clockCount[1] = 0;
+    runFor(200000);
+    stepSchedulerSendClock(false);
+    stepSchedulerSetLatency(0, 0);
+
+    TEST_ASSERT_GREATER_OR_EQUAL(8, clockCount[1]);
+    TEST_ASSERT_UINT32_WITHIN(1, clockCount[1], clockCount[0]);
+    // USB's first tick may pair with a DIN tick sent before the window
+    size_t first = clockUs[1][0] < clockUs[0][0] + 960 / 2 ? 1 : 0;
+    for (size_t i = 0; i + first < clockCount[1] && i < clockCount[0]; ++i)
+        TEST_ASSERT_UINT32_WITHIN(50, 960, static_cast<uint32_t>(clockUs[1][i + first] - clockUs[0][i]));
+}
+
+// The jitter histogram is copied by the dispatcher, not read under its feet
+void test_jitter_snapshot_taken_by_dispatcher()
+{
+    tempoSetTarget(120.0f, stepsPerBar, barTicks, 0);
+    runFor(2000000);
+    JitterHistogram histogram;
+    stepSchedulerRequestJitter();
+    TEST_ASSERT_FALSE(stepSchedulerJitter(histogram));
+    runFor(2000);
+    TEST_ASSERT_TRUE(stepSchedulerJitter(histogram));
+    TEST_ASSERT_GREATER_THAN(0, histogram.count);
+}
+
+int main(int argc, char **argv)
+{
+    stepSchedulerBegin({recordNoteOn, ignoreNoteOff, nullptr, recordRealtime, nullptr, nullptr});
+    UNITY_BEGIN();
+    RUN_TEST(test_step_spacing);
+    RUN_TEST(test_stall_counts_late);
+    RUN_TEST(test_groove_lead_beyond_lookahead);
+    RUN_TEST(test_stop_holds_until_sync_change);
+    RUN_TEST(test_early_draws_keep_their_time);
+    RUN_TEST(test_clock_shifted_per_destination);
+    RUN_TEST(test_jitter_snapshot_taken_by_dispatcher);
+    return UNITY_END();
+}
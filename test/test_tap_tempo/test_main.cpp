@@ -0,0 +1,113 @@
+#include <unity.h>
+#include "TapTempo.h"
+
+// --- TAP TEMPO (host) ---
+// Taps on a 120 BPM grid (500 ms) with a skipped beat, a double tap and a
+// single early or late tap, plus the phase of the fitted beat grid.
+
+const uint64_t beatUs = 500000;
+const uint64_t firstTapUs = 1000000;
+
+static TapTempo tapTempo;
+
+// Tap on grid beat n, offset by offsetUs
+static bool tapBeat(int beat, int32_t offsetUs = 0)
+{
+    return tapTempo.tap(firstTapUs + beat * beatUs + offsetUs);
+}
+
+void setUp()
+{
+    tapTempo.reset();
+}
+
+void tearDown()
+{
+}
+
+// Even taps: 120 BPM once minTaps are in, not before
+void test_steady_taps()
+{
+    TEST_ASSERT_FALSE(tapBeat(0));
+    TEST_ASSERT_FALSE(tapBeat(1));
+    TEST_ASSERT_TRUE(tapBeat(2));
+    TEST_ASSERT_TRUE(tapBeat(3));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, beatUs, tapTempo.periodUs());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 120.0f, tapTempo.bpm());
+}
+
+// Beat 3 not tapped: the 1 s gap counts as two beats, not a slower tempo
+void test_missed_tap_counts_two_beats()
+{
+    tapBeat(0);
+    tapBeat(1);
+    tapBeat(2);
+    tapBeat(4);
+    TEST_ASSERT_TRUE(tapBeat(5));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, beatUs, tapTempo.periodUs());
+}
+
+// A bounce 20 ms after a tap is dropped, not read as a beat
+void test_double_tap_dropped()
+{
+    tapBeat(0);
+    tapBeat(1);
+    tapBeat(2);
+    tapBeat(2, 20000);
+    tapBeat(3);
+    TEST_ASSERT_TRUE(tapBeat(4));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, beatUs, tapTempo.periodUs());
+}
+
+// One tap 100 ms late among steady ones does not pull the period
+void test_late_outlier_rejected()
+{
+    for (int beat = 0; beat < 6; ++beat)
+        tapBeat(beat, beat == 3 ? 100000 : 0);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, beatUs, tapTempo.periodUs());
+}
+
+// ...nor does one 100 ms early
+void test_early_outlier_rejected()
+{
+    for (int beat = 0; beat < 6; ++beat)
+        tapBeat(beat, beat == 3 ? -100000 : 0);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, beatUs, tapTempo.periodUs());
+}
+
+// The fitted grid passes through the taps: the next beat after any time is
+// on the tapped grid, even with the last tap slightly off it
+void test_next_beat_in_phase()
+{
+    for (int beat = 0; beat < 6; ++beat)
+        tapBeat(beat, beat == 5 ? 8000 : 0);
+    uint64_t lastBeatUs = firstTapUs + 5 * beatUs;
+    TEST_ASSERT_UINT32_WITHIN(2, beatUs, static_cast<uint32_t>(tapTempo.nextBeatUs(lastBeatUs + 10000) - lastBeatUs));
+    TEST_ASSERT_UINT32_WITHIN(2, 3 * beatUs, static_cast<uint32_t>(tapTempo.nextBeatUs(lastBeatUs + 1250000) - lastBeatUs));
+}
+
+// A pause longer than maxTapGapUs starts a new estimate
+void test_long_pause_starts_over()
+{
+    tapBeat(0);
+    tapBeat(1);
+    tapBeat(2);
+    uint64_t restartUs = firstTapUs + 2 * beatUs + TapTempo::maxTapGapUs + 1;
+    TEST_ASSERT_FALSE(tapTempo.tap(restartUs));
+    TEST_ASSERT_FALSE(tapTempo.tap(restartUs + 400000));
+    TEST_ASSERT_TRUE(tapTempo.tap(restartUs + 800000));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 400000, tapTempo.periodUs());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_taps);
+    RUN_TEST(test_missed_tap_counts_two_beats);
+    RUN_TEST(test_double_tap_dropped);
+    RUN_TEST(test_late_outlier_rejected);
+    RUN_TEST(test_early_outlier_rejected);
+    RUN_TEST(test_next_beat_in_phase);
+    RUN_TEST(test_long_pause_starts_over);
+    return UNITY_END();
+}
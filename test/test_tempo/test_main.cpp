@@ -0,0 +1,74 @@
+#include <unity.h>
+#include "Tempo.h"
+#include "Timebase.h"
+#include "Constants.h"
+
+// --- TEMPO (host) ---
+// The Bresenham carry: every run of stepsPerBar step periods adds up to the
+// bar period exactly, in every meter, at tempos whose bar does not divide.
+
+const float testTempos[] = {120.0f, 97.3f, 173.13f};
+
+static uint32_t bpmQ16(float bpm)
+{
+    return static_cast<uint32_t>(bpm * 65536.0f + 0.5f);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// Any stepsPerBar consecutive periods sum to the bar, over several bars and
+// from every starting step
+static void checkBarSums(int steps, int barTicks, float bpm)
+{
+    const int bars = 3;
+    uint64_t periods[bars * 32];
+    tempoSetTarget(bpm, steps, barTicks, 0);
+    uint64_t barQ32 = barPeriodFromTempoQ16(bpmQ16(bpm), barTicks);
+    for (int i = 0; i < bars * steps; ++i)
+    {
+        periods[i] = tempoAdvanceStep();
+        // Steps differ from the nominal period by at most the carried unit
+        TEST_ASSERT_TRUE(periods[i] - tempoStepPeriodQ32() <= 1);
+    }
+    for (int first = 0; first + steps <= bars * steps; ++first)
+    {
+        uint64_t sum = 0;
+        for (int i = first; i < first + steps; ++i)
+            sum += periods[i];
+        TEST_ASSERT_TRUE(sum == barQ32);
+    }
+}
+
+void test_bar_sums_exact_all_meters()
+{
+    for (float bpm : testTempos)
+        for (const TimeSignature &signature : timeSignatureOptions)
+            for (int steps : stepsPerBarOptions)
+                checkBarSums(steps, barTicksFor(signature), bpm);
+}
+
+// The odd splits the carry is there for: 5 and 7 steps in 4/4, 9 in 7/8
+void test_odd_splits_carry()
+{
+    // Bars that leave a remainder, so truncated periods would fall short
+    TEST_ASSERT_TRUE(barPeriodFromTempoQ16(bpmQ16(97.3f), 96) % 5 != 0);
+    TEST_ASSERT_TRUE(barPeriodFromTempoQ16(bpmQ16(120.0f), 96) % 7 != 0);
+    TEST_ASSERT_TRUE(barPeriodFromTempoQ16(bpmQ16(173.13f), 84) % 9 != 0);
+    checkBarSums(5, 96, 97.3f);
+    checkBarSums(7, 96, 120.0f);
+    checkBarSums(9, 84, 173.13f);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bar_sums_exact_all_meters);
+    RUN_TEST(test_odd_splits_carry);
+    return UNITY_END();
+}
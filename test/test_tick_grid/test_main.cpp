@@ -0,0 +1,95 @@
+#include <unity.h>
+#include "TickGrid.h"
+
+// --- TICK GRID (host) ---
+// Step positions under external clock are exact rationals of the bar: 5, 7
+// and 9 steps in several meters, at every clock ratio, never drift.
+
+const int oddSteps[] = {5, 7, 9};
+const TimeSignature testMeters[] = {{4, 4}, {3, 4}, {5, 4}, {7, 8}, {6, 8}};
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// Position of step n, straight from the rational ticks per step
+static void checkPosition(const TickPosition &position, uint32_t step, const TickDivision &division)
+{
+    uint64_t stepTicks = static_cast<uint64_t>(step) * division.barTicks;
+    TEST_ASSERT_EQUAL_UINT32(step, position.step);
+    TEST_ASSERT_EQUAL_UINT32(stepTicks / division.steps, position.tick);
+    TEST_ASSERT_EQUAL_UINT32(stepTicks % division.steps, position.remainder);
+}
+
+// advance() lands on exact step positions, and on the barline every bar
+void test_advance_exact()
+{
+    for (int r = 0; r < CLOCK_RATIO_COUNT; ++r)
+        for (const TimeSignature &meter : testMeters)
+            for (int steps : oddSteps)
+            {
+                const TickDivision &division = tickDivisionFor(steps, barTicksFor(meter), static_cast<ClockRatio>(r));
+                TEST_ASSERT_EQUAL(steps, division.steps);
+                TickPosition position = {0, 0, 0};
+                for (uint32_t step = 1; step <= 16 * static_cast<uint32_t>(steps); ++step)
+                {
+                    position.advance(division);
+                    checkPosition(position, step, division);
+                    if (step % steps == 0)
+                    {
+                        TEST_ASSERT_EQUAL_UINT32(step / steps * division.barTicks, position.tick);
+                        TEST_ASSERT_EQUAL_UINT32(0, position.remainder);
+                    }
+                }
+            }
+}
+
+// tickPositionAtOrAfter() finds the first step boundary at or after each tick
+// and agrees with walking there with advance()
+void test_position_at_or_after_exact()
+{
+    for (int r = 0; r < CLOCK_RATIO_COUNT; ++r)
+        for (const TimeSignature &meter : testMeters)
+            for (int steps : oddSteps)
+            {
+                const TickDivision &division = tickDivisionFor(steps, barTicksFor(meter), static_cast<ClockRatio>(r));
+                TickPosition walked = {0, 0, 0};
+                for (uint32_t tick = 0; tick <= 4u * division.barTicks; ++tick)
+                {
+                    while (walked.tick < tick)
+                        walked.advance(division);
+                    TickPosition position = tickPositionAtOrAfter(tick, division);
+                    checkPosition(position, walked.step, division);
+                    // The step before it lies before the tick
+                    uint64_t scaledTick = static_cast<uint64_t>(tick) * division.steps;
+                    TEST_ASSERT_TRUE(static_cast<uint64_t>(position.step) * division.barTicks >= scaledTick);
+                    if (position.step > 0)
+                        TEST_ASSERT_TRUE(static_cast<uint64_t>(position.step - 1) * division.barTicks < scaledTick);
+                }
+            }
+}
+
+// Far into a song (a Song Position jump) the position is still exact
+void test_position_far_into_song()
+{
+    const TickDivision &division = tickDivisionFor(7, barTicksFor({5, 4}));
+    uint32_t tick = 1000003;
+    TickPosition position = tickPositionAtOrAfter(tick, division);
+    uint64_t scaledTick = static_cast<uint64_t>(tick) * division.steps;
+    TEST_ASSERT_TRUE(static_cast<uint64_t>(position.step) * division.barTicks >= scaledTick);
+    TEST_ASSERT_TRUE(static_cast<uint64_t>(position.step - 1) * division.barTicks < scaledTick);
+    checkPosition(position, position.step, division);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_advance_exact);
+    RUN_TEST(test_position_at_or_after_exact);
+    RUN_TEST(test_position_far_into_song);
+    return UNITY_END();
+}